@@ -50,6 +50,18 @@ class Config
     llvm::SmallString<0> configDir_;
     std::string sourceRoot_;
     std::vector<llvm::SmallString<0>> inputFileIncludes_;
+    std::string astManifest_;
+    std::string statsFile_;
+    std::vector<std::string> publicHeaders_;
+    std::string intermediateFormat_ = "bitcode";
+    unsigned mapJobs_ = 0;
+    unsigned reduceJobs_ = 0;
+    unsigned genJobs_ = 0;
+    unsigned memoryBudget_ = 0;
+    unsigned mapRetries_ = 0;
+    unsigned mapTimeout_ = 0;
+    bool isolateMap_ = false;
+    bool multiPage_ = false;
     bool verbose_ = true;
     bool includePrivate_ = false;
 
@@ -146,6 +158,134 @@ public:
         return includePrivate_;
     }
 
+    /** Return the full path to the AST manifest, or an empty string.
+
+        The manifest lists pre-built AST files produced
+        by the project's build with `-emit-ast`. When a
+        translation unit has an up to date entry, the
+        AST is loaded from disk instead of parsing.
+    */
+    llvm::StringRef
+    astManifest() const noexcept
+    {
+        return astManifest_;
+    }
+
+    /** Return the full path to the statistics file, or an empty string.
+
+        The statistics file records the time taken to
+        map each translation unit, and its peak memory.
+        It is read to start the slowest translation units
+        first and to estimate their memory for the memory
+        budget, and updated at the end of the map phase.
+    */
+    llvm::StringRef
+    statsFile() const noexcept
+    {
+        return statsFile_;
+    }
+
+    /** Return the glob patterns matching public headers.
+
+        When this list is not empty, the documentation
+        is extracted from synthetic translation units
+        which include every matching header, instead
+        of from the translation units in the
+        compilation database.
+    */
+    std::vector<std::string> const&
+    publicHeaders() const noexcept
+    {
+        return publicHeaders_;
+    }
+
+    /** Return the name of the intermediate format.
+
+        This selects the codec used to pass the
+        metadata of each translation unit from
+        the mapping phase to the reducing phase.
+        It is either "bitcode" or "flat".
+    */
+    llvm::StringRef
+    intermediateFormat() const noexcept
+    {
+        return intermediateFormat_;
+    }
+
+    /** Return the largest number of translation units visited at once.
+
+        Zero means one per hardware thread.
+    */
+    unsigned
+    mapJobs() const noexcept
+    {
+        return mapJobs_;
+    }
+
+    /** Return the largest number of threads merging symbols at once.
+
+        Zero means one per hardware thread.
+    */
+    unsigned
+    reduceJobs() const noexcept
+    {
+        return reduceJobs_;
+    }
+
+    /** Return the largest number of threads generating output at once.
+
+        Zero means one per hardware thread.
+    */
+    unsigned
+    genJobs() const noexcept
+    {
+        return genJobs_;
+    }
+
+    /** Return the memory budget of the map phase, in megabytes.
+
+        Zero means there is no limit.
+    */
+    unsigned
+    memoryBudget() const noexcept
+    {
+        return memoryBudget_;
+    }
+
+    /** Return true if translation units are mapped in worker processes.
+    */
+    bool
+    isolateMap() const noexcept
+    {
+        return isolateMap_;
+    }
+
+    /** Return how many times a translation unit is retried after its worker process fails.
+    */
+    unsigned
+    mapRetries() const noexcept
+    {
+        return mapRetries_;
+    }
+
+    /** Return the seconds after which a worker process is considered to hang.
+
+        Zero means there is no limit.
+    */
+    unsigned
+    mapTimeout() const noexcept
+    {
+        return mapTimeout_;
+    }
+
+    /** Return true if generators which support it emit one page per symbol.
+    */
+    bool
+    multiPage() const noexcept
+    {
+        return multiPage_;
+    }
+
     /** Returns true if the translation unit should be visited.
 
         @param filePath The posix-style full path
@@ -217,6 +357,160 @@ public:
     void
     setInputFileIncludes(
         std::vector<std::string> const& list);
+
+    /** Set the path to the AST manifest.
+
+        The manifest is a JSON array of objects, each
+        with a "file" and an "ast" member. Relative
+        paths in the manifest are resolved against
+        the directory containing the manifest.
+
+        If the specified path is relative, then
+        the full path will be computed relative to
+        @ref configDir(). An empty path disables
+        loading pre-built AST files.
+
+        @param filePath The path to the manifest.
+    */
+    void
+    setASTManifest(
+        llvm::StringRef filePath);
+
+    /** Set the path to the statistics file.
+
+        If the specified path is relative, then
+        the full path will be computed relative to
+        @ref configDir(). An empty path disables
+        the statistics.
+
+        @param filePath The path to the file.
+    */
+    void
+    setStatsFile(
+        llvm::StringRef filePath);
+
+    /** Set the glob patterns matching public headers.
+
+        Each pattern is matched against the posix-style
+        path of a file relative to @ref sourceRoot().
+        A `*` in the pattern also matches directory
+        separators. Decls which only appear in source
+        files are not documented in this mode, and the
+        filter for including translation units does
+        not apply.
+
+        @param list The list of patterns.
+    */
+    void
+    setPublicHeaders(
+        std::vector<std::string> const& list);
+
+    /** Set the name of the intermediate format.
+
+        The "bitcode" format is compact, while the
+        byte-aligned "flat" format is faster to
+        write and read. An unknown name is reported
+        when the corpus is built.
+
+        @param format The name of the format.
+    */
+    void
+    setIntermediateFormat(
+        llvm::StringRef format);
+
+    /** Set the concurrency limit of each phase.
+
+        All phases share one pool of threads, and
+        a limit of zero allows one job per hardware
+        thread. When run from a parallel make, the
+        jobs beyond the first also need a token from
+        the make jobserver.
+
+        @param mapJobs The limit for visiting
+        translation units.
+
+        @param reduceJobs The limit for merging
+        symbols.
+
+        @param genJobs The limit for generating
+        output.
+    */
+    void
+    setJobs(
+        unsigned mapJobs,
+        unsigned reduceJobs,
+        unsigned genJobs) noexcept
+    {
+        mapJobs_ = mapJobs;
+        reduceJobs_ = reduceJobs;
+        genJobs_ = genJobs;
+    }
+
+    /** Set the memory budget of the map phase.
+
+        A translation unit is parsed only while the
+        estimated memory of all of the translation
+        units being mapped fits in the budget. Small
+        translation units can thus go ahead while a
+        large one waits.
+
+        @param megabytes The budget in megabytes,
+        or zero for no limit.
+    */
+    void
+    setMemoryBudget(
+        unsigned megabytes) noexcept
+    {
+        memoryBudget_ = megabytes;
+    }
+
+    /** Set whether translation units are mapped in worker processes.
+
+        In this mode each mapping thread forks a child
+        process which parses its translation units, so
+        a crash or a hang in clang takes down only the
+        translation unit being mapped. The failure is
+        reported, and the translation unit is retried
+        or skipped while the other workers go on.
+        This is only supported on POSIX systems.
+
+        @param isolate Whether to use worker processes.
+
+        @param retries How many times a translation
+        unit is retried in a new worker process.
+
+        @param timeoutSeconds The seconds after which a
+        worker is killed, or zero for no limit.
+    */
+    void
+    setMapIsolation(
+        bool isolate,
+        unsigned retries,
+        unsigned timeoutSeconds) noexcept
+    {
+        isolateMap_ = isolate;
+        mapRetries_ = retries;
+        mapTimeout_ = timeoutSeconds;
+    }
+
+    /** Set whether output is split into one page per symbol.
+
+        When set, generators which support it write
+        a page for every namespace, record and overload
+        set into a tree of directories which mirrors
+        the scopes, instead of a single file. A search
+        index of the pages, `search-index.txt`, and
+        the script which queries it, `search.js`, are
+        written next to them.
+
+        @param multiPage Whether to emit multiple pages.
+    */
+    void
+    setMultiPage(
+        bool multiPage) noexcept
+    {
+        multiPage_ = multiPage;
+    }
 };
 
 } // mrdox
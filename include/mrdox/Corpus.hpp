@@ -17,26 +17,31 @@
 #include <mrdox/Reporter.hpp>
 #include <mrdox/meta/Index.hpp>
 #include <mrdox/meta/Types.hpp>
-#include <clang/Tooling/Execution.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <llvm/ADT/StringMap.h>
 #include <llvm/Support/Mutex.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <type_traits>
 #include <vector>
 
 namespace clang {
 namespace mrdox {
 
+class Scheduler;
+class ScopeOverloads;
+
 /** The collection of declarations in extracted form.
 */
 class Corpus
 {
     Config const& config_;
+    std::unique_ptr<Scheduler> scheduler_;
 
     explicit
     Corpus(
-        Config const& config) noexcept
-        : config_(config)
-    {
-    }
+        Config const& config) noexcept;
 
 public:
     /** Index of all emitted symbols.
@@ -52,6 +57,10 @@ public:
     std::vector<SymbolID> allSymbols;
 
 public:
+    /** Destructor.
+    */
+    ~Corpus();
+
     //--------------------------------------------
     //
     // Modifiers
@@ -60,6 +69,9 @@ public:
 
     /** Build the intermediate representation of the code being documented.
 
+        @param db The compilation database with the
+        translation units to visit.
+
         @param config The configuration, whose lifetime
         must extend until the corpus is destroyed.
 
@@ -70,21 +82,13 @@ public:
     static
     llvm::Expected<std::unique_ptr<Corpus>>
     build(
-        tooling::ToolExecutor& ex,
+        tooling::CompilationDatabase const& db,
         Config const& config,
         Reporter& R);
 
     /** Sort an array of Info by fully qualified name
     */
 
-    /** Store the Info in the tool results, keyed by SymbolID.
-    */
-    static
-    void
-    reportResult(
-        tooling::ExecutionContext& exc,
-        Info const& I);
-
     //--------------------------------------------
     //
     // Observers
@@ -106,6 +110,48 @@ public:
         llvm::StringRef symbolName0,
         llvm::StringRef symbolName1) noexcept;
 
+    /** Return the scheduler which runs the work of every phase.
+
+        Generators use this to render in parallel,
+        on the same threads as the other phases.
+    */
+    Scheduler&
+    scheduler() const noexcept
+    {
+        return *scheduler_;
+    }
+
+    /** Return the content hash of a symbol.
+
+        The hash covers the metadata of the symbol,
+        including the names and briefs it refers to,
+        and the hashes of every symbol in its scope,
+        recursively. It changes whenever anything
+        rendered for the symbol or its members
+        changes, and is the same across runs when
+        nothing did. Zero is returned for a symbol
+        which is not in the corpus.
+
+        The hashes of every symbol are calculated
+        together, the first time one is asked for,
+        so output which does not use them does
+        not pay for them.
+    */
+    std::uint64_t
+    hash(
+        SymbolID const& id) const noexcept;
+
+    /** Return the overload sets of a namespace or record.
+
+        The sets of every scope are calculated together,
+        the first time any is asked for. An empty object
+        is returned for any other symbol. The type is
+        declared in <mrdox/format/OverloadSet.hpp>.
+    */
+    ScopeOverloads const&
+    overloads(
+        SymbolID const& id) const noexcept;
+
     /** Return the ID of the global namespace.
     */
     static
@@ -169,6 +215,7 @@ public:
     
 private:
     struct Temps;
+    struct Overloads;
 
     //--------------------------------------------
     //
@@ -210,9 +257,26 @@ private:
     bool canonicalize(std::vector<Reference>& list, Temps& t, Reporter& R);
     bool canonicalize(llvm::SmallVectorImpl<MemberTypeInfo>& list, Temps& t, Reporter& R);
 
+    /** Calculate the hash of every symbol.
+
+        This must be called after canonicalization.
+    */
+    void computeHashes() const;
+    std::uint64_t foldHash(Info const& I, Scope const& scope) const;
+
+    /** Calculate the overload sets of every scope.
+
+        This must be called after canonicalization.
+    */
+    void computeOverloads() const;
+
 private:
     llvm::sys::Mutex infoMutex;
     llvm::sys::Mutex allSymbolsMutex;
+    mutable std::once_flag hashesOnce_;
+    mutable llvm::StringMap<std::uint64_t> hashes_;
+    mutable std::once_flag overloadsOnce_;
+    mutable std::unique_ptr<Overloads> overloads_;
     bool isCanonical_ = false;
 };
 
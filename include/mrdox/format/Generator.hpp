@@ -18,6 +18,7 @@
 #include <mrdox/Config.hpp>
 #include <mrdox/Corpus.hpp>
 #include <mrdox/Reporter.hpp>
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/ADT/StringRef.h>
 
 namespace clang {
@@ -59,8 +60,8 @@ struct Generator
         root directory and the generator's extension.
 
         @par Thread Safety
-        @li Different `corpus` object: may be called concurrently.
-        @li Same `corpus` object: may not be called concurrently.
+        May be called concurrently, including
+        with the same `corpus` object.
 
         @return `true` upon success.
 
@@ -70,8 +71,7 @@ struct Generator
         to emit output as a single file.
 
         @par corpus The symbols to emit. The
-        generator may modify the contents of
-        the object before returning.
+        generator does not modify the corpus.
 
         @par config The configuration to use.
 
@@ -82,15 +82,15 @@ struct Generator
     bool
     build(
         llvm::StringRef outputPath,
-        Corpus& corpus,
+        Corpus const& corpus,
         Config const& config,
         Reporter& R) const;
 
     /** Build single-file documentation from the corpus and configuration.
 
         @par Thread Safety
-        @li Different `corpus` object: may be called concurrently.
-        @li Same `corpus` object: may not be called concurrently.
+        May be called concurrently, including
+        with the same `corpus` object.
 
         @return `true` upon success.
 
@@ -99,8 +99,7 @@ struct Generator
         the generated results.
 
         @par corpus The symbols to emit. The
-        generator may modify the contents of
-        the object before returning.
+        generator does not modify the corpus.
 
         @par config The configuration to use.
 
@@ -111,15 +110,15 @@ struct Generator
     bool
     buildOne(
         llvm::StringRef fileName,
-        Corpus& corpus,
+        Corpus const& corpus,
         Config const& config,
         Reporter& R) const = 0;
 
     /** Build a string containing the single-file documentation.
 
         @par Thread Safety
-        @li Different `corpus` object: may be called concurrently.
-        @li Same `corpus` object: may not be called concurrently.
+        May be called concurrently, including
+        with the same `corpus` object.
 
         @return `true` upon success.
 
@@ -128,8 +127,7 @@ struct Generator
         not be accessed by any other threads.
 
         @par corpus The symbols to emit. The
-        generator may modify the contents of
-        the object before returning.
+        generator does not modify the corpus.
 
         @par config The configuration to use.
 
@@ -140,11 +138,43 @@ struct Generator
     bool
     buildString(
         std::string& dest,
-        Corpus& corpus,
+        Corpus const& corpus,
         Config const& config,
         Reporter& R) const = 0;
 };
 
+/** Build documentation with several generators at once.
+
+    The corpus is built once and shared by every
+    generator, which run concurrently under the
+    limit for generating output. Each generator
+    calls @ref Generator::build with the same
+    output path.
+
+    @return `true` if every generator succeeded.
+
+    @par generators The generators to run.
+
+    @par outputPath The path to a directory for
+    emitting the output of every generator. A path
+    to an existing file is only allowed with one
+    generator, which then writes that file.
+
+    @par corpus The symbols to emit.
+
+    @par config The configuration to use.
+
+    @par R The diagnostic reporting object to
+    use for delivering errors and information.
+*/
+bool
+buildAll(
+    llvm::ArrayRef<Generator const*> generators,
+    llvm::StringRef outputPath,
+    Corpus const& corpus,
+    Config const& config,
+    Reporter& R);
+
 extern std::unique_ptr<Generator> makeXMLGenerator();
 extern std::unique_ptr<Generator> makeAsciidocGenerator();
 
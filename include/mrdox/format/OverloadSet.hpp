@@ -13,8 +13,11 @@
 #define MRDOX_META_OVERLOADSET_HPP
 
 #include <mrdox/meta/Function.hpp>
+#include <clang/Basic/Specifiers.h>
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/ADT/StringRef.h>
-#include <functional>
+#include <cstdint>
+#include <vector>
 
 namespace clang {
 namespace mrdox {
@@ -22,17 +25,78 @@ namespace mrdox {
 class Corpus;
 struct Scope;
 
+/** A set of functions in one scope with the same name.
+*/
 struct OverloadSet
 {
     llvm::StringRef name;
-    std::vector<FunctionInfo const*> list;
+    llvm::ArrayRef<FunctionInfo const*> list;
 };
 
-std::vector<OverloadSet>
-makeOverloadSet(
-    Corpus const& corpus,
-    Scope const& scope,
-    std::function<bool(FunctionInfo const&)> filter);
+/** The overload sets of one scope.
+
+    The functions of the scope are stored in one
+    array, grouped by access and then by name, and
+    each set refers to a range of it. When the scope
+    has functions with more than one access, they
+    are also grouped by name alone after that.
+    Functions with the same name keep the order
+    of the scope.
+*/
+class ScopeOverloads
+{
+    std::vector<FunctionInfo const*> functions_;
+    std::vector<OverloadSet> sets_;
+
+    // Index of the first set with each access,
+    // followed by the index of the first set
+    // which ignores the access.
+    std::uint32_t first_[5] = {};
+
+public:
+    /** Constructor.
+
+        The object is empty.
+    */
+    ScopeOverloads() = default;
+
+    /** Constructor.
+
+        @param corpus The corpus which holds
+        the functions of the scope.
+
+        @param scope The scope to group.
+    */
+    ScopeOverloads(
+        Corpus const& corpus,
+        Scope const& scope);
+
+    // The sets refer to the array of functions
+    ScopeOverloads(ScopeOverloads&&) = default;
+    ScopeOverloads& operator=(ScopeOverloads&&) = default;
+    ScopeOverloads(ScopeOverloads const&) = delete;
+    ScopeOverloads& operator=(ScopeOverloads const&) = delete;
+
+    /** Return the sets of functions with the given access, by name.
+    */
+    llvm::ArrayRef<OverloadSet>
+    get(AccessSpecifier access) const noexcept
+    {
+        auto const i = static_cast<unsigned>(access);
+        return llvm::makeArrayRef(sets_).slice(
+            first_[i], first_[i + 1] - first_[i]);
+    }
+
+    /** Return the sets of every function regardless of access, by name.
+    */
+    llvm::ArrayRef<OverloadSet>
+    all() const noexcept
+    {
+        if(first_[4] == sets_.size())
+            return sets_;
+        return llvm::makeArrayRef(sets_).drop_front(first_[4]);
+    }
+};
 
 } // mrdox
 } // clang
@@ -17,6 +17,7 @@
 #include <mrdox/Reporter.hpp>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/raw_ostream.h>
+#include <memory>
 #include <string>
 
 namespace clang {
@@ -39,6 +40,14 @@ class Config;
     This base class is suitable for writing a single
     file using a recursive syntax such as that found
     in XML, HTML, or JSON.
+
+    When the subclass can create more writers, the
+    list of all symbols and each child of the global
+    namespace are rendered concurrently into separate
+    buffers, which are then written in order. Each
+    buffer starts at the nesting level where it is
+    inserted, so the output is the same as when
+    everything is written on one thread.
 */
 class RecursiveWriter
 {
@@ -92,6 +101,19 @@ public:
     void write();
 
 protected:
+    /** Return a writer of the same kind which writes to another stream.
+
+        The returned writer is used to render part
+        of the document concurrently, and must not
+        share any mutable state with this one. The
+        default implementation returns `nullptr`,
+        and the document is written on one thread.
+    */
+    virtual
+    std::unique_ptr<RecursiveWriter>
+    makeSubWriter(
+        llvm::raw_ostream& os);
+
     /** Called to write all symbols.
 
         Each element contains the fully qualified
@@ -132,6 +154,7 @@ private:
     void visit(RecordInfo const&);
     void visit(FunctionInfo const&);
     void visit(Scope const&);
+    void visitGlobal(NamespaceInfo const&);
 
     std::vector<AllSymbol> makeAllSymbols();
 };
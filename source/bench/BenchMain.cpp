@@ -0,0 +1,570 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+// Microbenchmarks for the intermediate formats.
+//
+// Each sample is encoded as if it came from one
+// translation unit, then decoded the way the
+// reducing phase does. The attributes which the
+// XML generator writes for each sample are also
+// measured, which should not allocate at all,
+// along with the scanners used to escape the text
+// of doc comments for each CPU feature level.
+// The results can be written as JSON and compared
+// across commits.
+//
+
+#include "Samples.hpp"
+#include "ast/Codec.hpp"
+#include "format/Asciidoc.hpp"
+#include "format/CharScanner.hpp"
+#include "format/XMLTags.hpp"
+#include <mrdox/Reporter.hpp>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Signals.h>
+#include <llvm/Support/raw_ostream.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+//------------------------------------------------
+//
+// Allocation counting
+//
+//------------------------------------------------
+
+namespace {
+
+std::atomic<std::size_t> allocCount = 0;
+std::atomic<std::size_t> allocBytes = 0;
+
+void
+countAlloc(
+    std::size_t size) noexcept
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+} // (anon)
+
+#ifdef __GLIBC__
+
+// The buffers of llvm::SmallVector and SmallString
+// grow with malloc and realloc rather than operator
+// new, so the C allocation functions are replaced.
+// Those of the C++ library call them in turn. The
+// functions of glibc remain callable by these names.
+
+extern "C" {
+
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* p, std::size_t size);
+void __libc_free(void* p);
+
+void*
+malloc(std::size_t size) noexcept
+{
+    countAlloc(size);
+    return __libc_malloc(size);
+}
+
+void*
+calloc(std::size_t count, std::size_t size) noexcept
+{
+    countAlloc(count * size);
+    return __libc_calloc(count, size);
+}
+
+void*
+realloc(void* p, std::size_t size) noexcept
+{
+    countAlloc(size);
+    return __libc_realloc(p, size);
+}
+
+void
+free(void* p) noexcept
+{
+    __libc_free(p);
+}
+
+} // extern "C"
+
+#else
+
+// Elsewhere only operator new is counted, so
+// the growth of llvm::SmallVector and SmallString,
+// which use malloc and realloc, is not seen.
+
+void*
+operator new(std::size_t size)
+{
+    countAlloc(size);
+    if(void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+#endif
+
+//------------------------------------------------
+
+namespace clang {
+namespace mrdox {
+
+namespace {
+
+llvm::cl::OptionCategory
+BenchCategory("mrdox_bench options");
+
+llvm::cl::opt<bool>
+JSONOutput(
+    "json",
+    llvm::cl::desc("Write the results to stdout as JSON."),
+    llvm::cl::cat(BenchCategory));
+
+llvm::cl::opt<std::string>
+Filter(
+    "filter",
+    llvm::cl::desc("Only run benchmarks whose name contains this string."),
+    llvm::cl::cat(BenchCategory));
+
+llvm::cl::opt<double>
+MinTime(
+    "min-time",
+    llvm::cl::desc("Minimum number of seconds to run each benchmark."),
+    llvm::cl::init(0.25),
+    llvm::cl::cat(BenchCategory));
+
+llvm::cl::opt<std::string>
+DocsFile(
+    "docs",
+    llvm::cl::desc("A file whose text is escaped by the escape benchmarks. "
+        "Defaults to doc comments from this project."),
+    llvm::cl::value_desc("path"),
+    llvm::cl::cat(BenchCategory));
+
+/*  Doc comments from this project, used when
+    no file is given for the escape benchmarks.
+*/
+constexpr char const* defaultDocs[] = {
+    "Return the value of an environment variable, or a default.\n"
+    "A relative path is resolved against the directory of the\n"
+    "configuration file, so the result is always absolute.\n",
+
+    "Returns the Info for the specified symbol ID, or nullptr if\n"
+    "the symbol was not found. The pointer remains valid for the\n"
+    "lifetime of the corpus.\n",
+
+    "Manipulator to apply XML escaping to output. Characters\n"
+    "such as `<`, `>` and `&` are written as entities, e.g.\n"
+    "`std::vector<int>&` becomes `std::vector&lt;int&gt;&amp;`.\n",
+
+    "Build the output for one corpus.\n"
+    "@param rootPath The directory to write into.\n"
+    "@param corpus The symbols, which are not modified.\n"
+    "@return true upon success, and errors are reported to `R`.\n",
+
+    "Write a list of attributes, each preceded by a space.\n"
+    "A predicate of `false` omits the attribute, as with\n"
+    "`{ \"name\", P.Name, ! P.Name.empty() }` for [unnamed] params.\n",
+
+    "Strings are referenced rather than copied, and symbol IDs\n"
+    "and numbers are formatted into a buffer inside the attribute,\n"
+    "so building a list of attributes never allocates.\n"
+};
+
+struct Result
+{
+    std::string name;
+    double nsPerOp = 0;
+    double bytesPerOp = 0;
+    double allocsPerOp = 0;
+    std::size_t iterations = 0;
+    std::size_t size = 0;
+};
+
+/*  Run the function repeatedly until the minimum
+    time has elapsed, and return the averages.
+*/
+template<class F>
+Result
+measure(
+    std::string name,
+    F const& f)
+{
+    using clock = std::chrono::steady_clock;
+
+    // Warm up the caches and the allocator.
+    f();
+
+    Result result;
+    result.name = std::move(name);
+    std::size_t n = 1;
+    for(;;)
+    {
+        std::size_t const count0 = allocCount.load();
+        std::size_t const bytes0 = allocBytes.load();
+        auto const start = clock::now();
+        for(std::size_t i = 0; i < n; ++i)
+            f();
+        std::chrono::duration<double> const elapsed =
+            clock::now() - start;
+        if(elapsed.count() >= MinTime || n >= (std::size_t(1) << 30))
+        {
+            result.iterations = n;
+            result.nsPerOp = elapsed.count() * 1e9 / n;
+            result.allocsPerOp = double(allocCount.load() - count0) / n;
+            result.bytesPerOp = double(allocBytes.load() - bytes0) / n;
+            return result;
+        }
+        n *= 2;
+    }
+}
+
+/*  Benchmark one sample with one codec.
+*/
+bool
+runSample(
+    Codec const& codec,
+    Sample const& sample,
+    std::vector<Result>& results,
+    Reporter& R)
+{
+    auto encode = [&]
+    {
+        auto encoder = codec.makeEncoder();
+        for(auto const& I : sample.infos)
+            encoder->write(*I);
+        return encoder->release();
+    };
+
+    std::string const prefix =
+        codec.name().str() + "/" + sample.name;
+    TUData const tu = encode();
+    if(tu.index.size() != sample.infos.size())
+    {
+        R.print("error: ", prefix, " encoded ", tu.index.size(),
+            " of ", sample.infos.size(), " Info");
+        R.reportError();
+        return false;
+    }
+
+    // Check the round trip once, outside of the timing loop.
+    {
+        auto decoder = codec.makeDecoder(tu, R);
+        if(R.error(decoder, "read ", prefix))
+            return false;
+        for(auto const& slice : tu.index)
+            if(R.error((*decoder)->read(slice), "read ", prefix))
+                return false;
+    }
+
+    std::string const encodeName = prefix + "/encode";
+    if(encodeName.find(Filter) != std::string::npos)
+    {
+        results.push_back(measure(encodeName, [&]
+        {
+            TUData data = encode();
+            (void)data;
+        }));
+        results.back().size = tu.data.size();
+    }
+
+    std::string const decodeName = prefix + "/decode";
+    if(decodeName.find(Filter) != std::string::npos)
+    {
+        results.push_back(measure(decodeName, [&]
+        {
+            // The round trip was checked above.
+            auto decoder = llvm::cantFail(codec.makeDecoder(tu, R));
+            for(auto const& slice : tu.index)
+            {
+                auto I = llvm::cantFail(decoder->read(slice));
+                (void)I;
+            }
+        }));
+        results.back().size = tu.data.size();
+    }
+
+    // The reduce phase decodes into an arena which
+    // is reset after each symbol is merged.
+    std::string const arenaName = prefix + "/decode-arena";
+    if(arenaName.find(Filter) != std::string::npos)
+    {
+        results.push_back(measure(arenaName, [&]
+        {
+            auto decoder = llvm::cantFail(codec.makeDecoder(tu, R));
+            InfoArena arena;
+            for(auto const& slice : tu.index)
+            {
+                llvm::cantFail(decoder->read(slice, &arena));
+                arena.reset();
+            }
+        }));
+        results.back().size = tu.data.size();
+    }
+    return true;
+}
+
+/*  Write the attributes the XML generator emits for a symbol.
+*/
+void
+writeSymbolAttrs(
+    llvm::raw_ostream& os,
+    Info const& I)
+{
+    xml::writeAttrs(os, {
+        { "name", I.Name },
+        { I.USR } });
+    if(I.IT == InfoType::IT_function)
+    {
+        auto const& F = static_cast<FunctionInfo const&>(I);
+        for(auto const& loc : F.Loc)
+            xml::writeAttrs(os, {
+                { "path", loc.Filename },
+                { "line", loc.LineNumber } });
+        for(auto const& P : F.Params)
+            xml::writeAttrs(os, {
+                { "name", P.Name, ! P.Name.empty() },
+                { "type", P.Type.Name },
+                { P.Type.USR } });
+    }
+    else if(I.IT == InfoType::IT_record)
+    {
+        auto const& R = static_cast<RecordInfo const&>(I);
+        for(auto const& M : R.Members)
+            xml::writeAttrs(os, {
+                { "name", M.Name },
+                { "type", M.Type.Name },
+                { M.Access },
+                { M.Type.USR } });
+    }
+}
+
+/*  Benchmark the XML attributes of one sample.
+*/
+void
+runXMLSample(
+    Sample const& sample,
+    std::vector<Result>& results)
+{
+    std::string const name = "xml/" + sample.name + "/attrs";
+    if(name.find(Filter) == std::string::npos)
+        return;
+
+    // The buffer keeps its capacity, so only
+    // the attributes themselves could allocate.
+    std::string out;
+    llvm::raw_string_ostream os(out);
+    results.push_back(measure(name, [&]
+    {
+        out.clear();
+        for(auto const& I : sample.infos)
+            writeSymbolAttrs(os, *I);
+    }));
+    results.back().size = out.size();
+}
+
+/*  Return the text used by the escape benchmarks.
+*/
+bool
+loadDocs(
+    std::string& text,
+    Reporter& R)
+{
+    if(! DocsFile.empty())
+    {
+        auto fileText = llvm::MemoryBuffer::getFile(DocsFile);
+        if(R.error(fileText, "read the file '", DocsFile.getValue(), "'"))
+            return false;
+        text = (*fileText)->getBuffer().str();
+        return true;
+    }
+
+    // Repeat the samples so that one run spans
+    // many vectors and not just the first few.
+    while(text.size() < 64 * 1024)
+        for(char const* docs : defaultDocs)
+            text += docs;
+    return true;
+}
+
+/*  Benchmark the escape scanners on doc comment text.
+
+    Every supported scanner finds each character
+    of the XML and Asciidoc sets, so the results
+    show the throughput of each CPU feature level.
+*/
+void
+runEscape(
+    llvm::StringRef text,
+    std::vector<Result>& results)
+{
+    using Kind = CharScanner::Kind;
+
+    struct Set
+    {
+        char const* name;
+        llvm::StringRef chars;
+    };
+    static constexpr Set sets[] = {
+        { "xml",  xml::escape::chars },
+        { "adoc", asciidoc::escape::chars } };
+
+    for(Kind kind : { Kind::scalar, Kind::sse2, Kind::avx2 })
+    {
+        if(! CharScanner::isSupported(kind))
+            continue;
+        for(auto const& set : sets)
+        {
+            std::string const name = "escape/" +
+                CharScanner::name(kind).str() + "/" + set.name;
+            if(name.find(Filter) == std::string::npos)
+                continue;
+            CharScanner const scanner(set.chars, kind);
+            std::size_t found = 0;
+            results.push_back(measure(name, [&]
+            {
+                found = 0;
+                for(auto pos = scanner.find(text);
+                    pos != llvm::StringRef::npos;
+                    pos = scanner.find(text, pos + 1))
+                    ++found;
+            }));
+            results.back().size = text.size();
+        }
+    }
+
+    std::string const name = "escape/xml";
+    if(name.find(Filter) == std::string::npos)
+        return;
+    std::string out;
+    llvm::raw_string_ostream os(out);
+    results.push_back(measure(name, [&]
+    {
+        out.clear();
+        os << xml::escape(text);
+    }));
+    results.back().size = text.size();
+}
+
+void
+printText(
+    std::vector<Result> const& results,
+    Reporter& R)
+{
+    for(auto const& r : results)
+        R.print(llvm::format("%-36s %12.1f ns/op %12.1f B/op "
+            "%10.1f allocs/op %10zu bytes",
+            r.name.c_str(), r.nsPerOp, r.bytesPerOp,
+            r.allocsPerOp, r.size));
+}
+
+void
+printJSON(
+    std::vector<Result> const& results)
+{
+    llvm::json::OStream J(llvm::outs(), 2);
+    J.array([&]
+    {
+        for(auto const& r : results)
+        {
+            J.object([&]
+            {
+                J.attribute("name", r.name);
+                J.attribute("ns_per_op", r.nsPerOp);
+                J.attribute("bytes_per_op", r.bytesPerOp);
+                J.attribute("allocs_per_op", r.allocsPerOp);
+                J.attribute("iterations", static_cast<int64_t>(r.iterations));
+                J.attribute("size", static_cast<int64_t>(r.size));
+            });
+        }
+    });
+    llvm::outs() << "\n";
+}
+
+} // (anon)
+
+//------------------------------------------------
+
+void
+benchMain(
+    int argc, char const** argv,
+    Reporter& R)
+{
+    llvm::cl::HideUnrelatedOptions(BenchCategory);
+    if(! llvm::cl::ParseCommandLineOptions(argc, argv,
+            "Microbenchmarks for the mrdox intermediate formats, XML output and escaping.\n"))
+        return;
+
+    std::vector<std::unique_ptr<Codec>> codecs;
+    codecs.emplace_back(makeBitcodeCodec());
+    codecs.emplace_back(makeFlatCodec());
+
+    std::vector<Sample> samples;
+    for(std::size_t n : { 4, 64, 1024 })
+    {
+        samples.emplace_back(makeRecordSample(n));
+        samples.emplace_back(makeFunctionSample(n));
+        samples.emplace_back(makeNamespaceSample(n));
+    }
+    samples.emplace_back(makeMixedSample(256));
+
+    std::vector<Result> results;
+    for(auto const& codec : codecs)
+        for(auto const& sample : samples)
+            if(! runSample(*codec, sample, results, R))
+                return;
+    for(auto const& sample : samples)
+        runXMLSample(sample, results);
+
+    std::string docs;
+    if(! loadDocs(docs, R))
+        return;
+    runEscape(docs, results);
+
+    if(JSONOutput)
+        printJSON(results);
+    else
+        printText(results, R);
+}
+
+} // mrdox
+} // clang
+
+//------------------------------------------------
+
+int main(int argc, char const** argv)
+{
+    llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
+
+    clang::mrdox::Reporter R;
+    clang::mrdox::benchMain(argc, argv, R);
+    return R.getExitCode();
+}
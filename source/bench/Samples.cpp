@@ -0,0 +1,243 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "Samples.hpp"
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/SHA1.h>
+
+namespace clang {
+namespace mrdox {
+
+namespace {
+
+/*  Return a symbol ID computed the same way as
+    the serializer does, from a made-up USR.
+*/
+SymbolID
+idOf(llvm::StringRef usr)
+{
+    return llvm::SHA1::hash(llvm::arrayRefFromStringRef(usr));
+}
+
+Javadoc::Paragraph
+makeParagraph(
+    llvm::StringRef subject,
+    std::size_t sentences)
+{
+    Javadoc::Paragraph p;
+    for(std::size_t i = 0; i < sentences; ++i)
+    {
+        Javadoc::append(p, Javadoc::Text(
+            "This sentence describes one aspect of " + subject.str() +
+            ", and is about as long as a line in a typical doc comment. "));
+        Javadoc::append(p, Javadoc::StyledText(
+            subject.str(), Javadoc::Style::mono));
+    }
+    return p;
+}
+
+Javadoc
+makeJavadoc(
+    llvm::StringRef subject,
+    std::size_t paragraphs,
+    std::vector<std::string> const& params,
+    std::vector<std::string> const& tparams)
+{
+    Javadoc jd;
+    {
+        Javadoc::Brief brief;
+        Javadoc::append(brief, Javadoc::Text(
+            "Brief description of " + subject.str()));
+        Javadoc::append(jd.blocks_, std::move(brief));
+    }
+    for(std::size_t i = 0; i < paragraphs; ++i)
+        Javadoc::append(jd.blocks_, makeParagraph(subject, 3));
+    for(auto const& name : params)
+        Javadoc::append(jd.params_, Javadoc::Param(
+            name, makeParagraph(name, 1)));
+    for(auto const& name : tparams)
+        Javadoc::append(jd.tparams_, Javadoc::TParam(
+            name, makeParagraph(name, 1)));
+    return jd;
+}
+
+Location
+makeLocation(
+    llvm::StringRef file,
+    std::size_t line)
+{
+    return Location(static_cast<int>(line), file, true);
+}
+
+void
+setNamespace(
+    Info& I,
+    llvm::StringRef scope)
+{
+    I.Namespace.emplace_back(idOf("c:@N@detail" + scope.str()),
+        "detail", InfoType::IT_namespace);
+    I.Namespace.emplace_back(idOf("c:@N@project"),
+        "project", InfoType::IT_namespace);
+    I.Path = "project/detail";
+}
+
+std::unique_ptr<RecordInfo>
+makeRecord(
+    llvm::StringRef name,
+    std::size_t n)
+{
+    auto I = std::make_unique<RecordInfo>(
+        idOf("c:@S@" + name.str()), name);
+    setNamespace(*I, name);
+    I->javadoc = makeJavadoc(name, 2, {}, { "T", "Allocator" });
+    I->DefLoc = makeLocation("include/project/detail/record.hpp", 42);
+    I->Loc.push_back(makeLocation("include/project/fwd.hpp", 17));
+    I->TagType = TagTypeKind::TTK_Class;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        std::string member = "member_" + std::to_string(i);
+        MemberTypeInfo M(
+            TypeInfo("std::vector<std::string>"),
+            member,
+            i % 3 ? AccessSpecifier::AS_private : AccessSpecifier::AS_public);
+        M.javadoc = makeJavadoc(member, 1, {}, {});
+        I->Members.emplace_back(std::move(M));
+    }
+    I->Parents.emplace_back(idOf("c:@S@base_" + name.str()),
+        "base_" + name.str(), InfoType::IT_record);
+    for(std::size_t i = 0; i < n; ++i)
+        I->Children.Functions.emplace_back(
+            idOf("c:@S@" + name.str() + "@F@f" + std::to_string(i)),
+            "f" + std::to_string(i), InfoType::IT_function);
+    I->Template.emplace();
+    I->Template->Params.emplace_back("class T");
+    I->Template->Params.emplace_back("class Allocator = std::allocator<T>");
+    return I;
+}
+
+std::unique_ptr<FunctionInfo>
+makeFunction(
+    llvm::StringRef name,
+    std::size_t n)
+{
+    auto I = std::make_unique<FunctionInfo>(
+        idOf("c:@F@" + name.str()));
+    I->Name = name;
+    setNamespace(*I, name);
+    std::vector<std::string> params;
+    for(std::size_t i = 0; i < n; ++i)
+        params.push_back("param_" + std::to_string(i));
+    I->javadoc = makeJavadoc(name, 8, params, { "T" });
+    I->javadoc.returns_ = Javadoc::Returns();
+    Javadoc::append(I->javadoc.returns_, Javadoc::Text(
+        "The result of calling " + name.str()));
+    I->DefLoc = makeLocation("src/project/detail/function.cpp", 314);
+    I->Loc.push_back(makeLocation("include/project/function.hpp", 27));
+    I->ReturnType = TypeInfo("std::optional<std::string>");
+    for(std::size_t i = 0; i < n; ++i)
+        I->Params.emplace_back(
+            TypeInfo("std::string_view"),
+            params[i],
+            i % 2 ? "\"default\"" : "");
+    I->Template.emplace();
+    I->Template->Params.emplace_back("class T");
+    return I;
+}
+
+std::unique_ptr<NamespaceInfo>
+makeNamespace(
+    llvm::StringRef name,
+    std::size_t n)
+{
+    auto I = std::make_unique<NamespaceInfo>(
+        idOf("c:@N@" + name.str()), name);
+    setNamespace(*I, name);
+    I->javadoc = makeJavadoc(name, 1, {}, {});
+    auto& C = I->Children;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        std::string suffix = std::to_string(i);
+        C.Namespaces.emplace_back(idOf("c:@N@" + name.str() + "@N@ns" + suffix),
+            "ns" + suffix, InfoType::IT_namespace);
+        C.Records.emplace_back(idOf("c:@N@" + name.str() + "@S@rec" + suffix),
+            "rec" + suffix, InfoType::IT_record);
+        C.Functions.emplace_back(idOf("c:@N@" + name.str() + "@F@fn" + suffix),
+            "fn" + suffix, InfoType::IT_function);
+    }
+    for(std::size_t i = 0; i < n / 8 + 1; ++i)
+    {
+        std::string suffix = std::to_string(i);
+        EnumInfo E(idOf("c:@N@" + name.str() + "@E@kind" + suffix));
+        E.Name = "kind" + suffix;
+        E.Scoped = true;
+        E.DefLoc = makeLocation("include/project/kinds.hpp", i);
+        for(int v = 0; v < 4; ++v)
+            E.Members.emplace_back(
+                "value" + std::to_string(v), std::to_string(v));
+        C.Enums.emplace_back(std::move(E));
+
+        TypedefInfo T(idOf("c:@N@" + name.str() + "@T@alias" + suffix));
+        T.Name = "alias" + suffix;
+        T.IsUsing = true;
+        T.Underlying = TypeInfo("std::map<std::string, int>");
+        T.DefLoc = makeLocation("include/project/aliases.hpp", i);
+        C.Typedefs.emplace_back(std::move(T));
+    }
+    return I;
+}
+
+} // (anon)
+
+//------------------------------------------------
+
+Sample
+makeRecordSample(std::size_t n)
+{
+    Sample s;
+    s.name = "record/" + std::to_string(n);
+    s.infos.emplace_back(makeRecord("widget", n));
+    return s;
+}
+
+Sample
+makeFunctionSample(std::size_t n)
+{
+    Sample s;
+    s.name = "function/" + std::to_string(n);
+    s.infos.emplace_back(makeFunction("transform", n));
+    return s;
+}
+
+Sample
+makeNamespaceSample(std::size_t n)
+{
+    Sample s;
+    s.name = "namespace/" + std::to_string(n);
+    s.infos.emplace_back(makeNamespace("library", n));
+    return s;
+}
+
+Sample
+makeMixedSample(std::size_t n)
+{
+    Sample s;
+    s.name = "mixed/" + std::to_string(n);
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        std::string suffix = std::to_string(i);
+        s.infos.emplace_back(makeRecord("record" + suffix, 8));
+        s.infos.emplace_back(makeFunction("function" + suffix, 4));
+        s.infos.emplace_back(makeNamespace("namespace" + suffix, 8));
+    }
+    return s;
+}
+
+} // mrdox
+} // clang
@@ -0,0 +1,64 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_BENCH_SAMPLES_HPP
+#define MRDOX_BENCH_SAMPLES_HPP
+
+#include <mrdox/Metadata.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace mrdox {
+
+/** A set of Info which is encoded and decoded as a unit.
+
+    The Info are written to a single encoder,
+    as if they came from one translation unit.
+*/
+struct Sample
+{
+    std::string name;
+    std::vector<std::unique_ptr<Info>> infos;
+};
+
+/** Return a record with many members and children.
+
+    @param n The number of members.
+*/
+Sample
+makeRecordSample(std::size_t n);
+
+/** Return a function with many params and a long doc comment.
+
+    @param n The number of params.
+*/
+Sample
+makeFunctionSample(std::size_t n);
+
+/** Return a namespace with huge child lists.
+
+    @param n The number of children of each kind.
+*/
+Sample
+makeNamespaceSample(std::size_t n);
+
+/** Return a mix of records, functions and namespaces.
+
+    @param n The number of each kind of Info.
+*/
+Sample
+makeMixedSample(std::size_t n);
+
+} // mrdox
+} // clang
+
+#endif
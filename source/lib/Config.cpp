@@ -31,6 +31,18 @@ struct Config::Options
     bool verbose = true;
     bool include_private = false;
     std::string source_root;
+    std::string ast_manifest;
+    std::string stats_file;
+    std::vector<std::string> public_headers;
+    std::string intermediate_format = "bitcode";
+    unsigned map_jobs = 0;
+    unsigned reduce_jobs = 0;
+    unsigned gen_jobs = 0;
+    unsigned memory_budget = 0;
+    bool isolate_map = false;
+    unsigned map_retries = 0;
+    unsigned map_timeout = 0;
+    bool multi_page = false;
     FileFilter input;
 };
 
@@ -59,6 +71,18 @@ struct llvm::yaml::MappingTraits<
         io.mapOptional("private",      opt.include_private);
         io.mapOptional("source-root",  opt.source_root);
         io.mapOptional("input",        opt.input);
+        io.mapOptional("ast-manifest", opt.ast_manifest);
+        io.mapOptional("stats-file",   opt.stats_file);
+        io.mapOptional("public-headers", opt.public_headers);
+        io.mapOptional("intermediate-format", opt.intermediate_format);
+        io.mapOptional("map-jobs",     opt.map_jobs);
+        io.mapOptional("reduce-jobs",  opt.reduce_jobs);
+        io.mapOptional("gen-jobs",     opt.gen_jobs);
+        io.mapOptional("memory-budget", opt.memory_budget);
+        io.mapOptional("isolate-map",  opt.isolate_map);
+        io.mapOptional("map-retries",  opt.map_retries);
+        io.mapOptional("map-timeout",  opt.map_timeout);
+        io.mapOptional("multi-page",   opt.multi_page);
     }
 };
 
@@ -154,6 +178,15 @@ loadFromFile(
     (*config)->setIncludePrivate(opt.include_private);
     (*config)->setSourceRoot(opt.source_root);
     (*config)->setInputFileIncludes(opt.input.include);
+    (*config)->setASTManifest(opt.ast_manifest);
+    (*config)->setStatsFile(opt.stats_file);
+    (*config)->setPublicHeaders(opt.public_headers);
+    (*config)->setIntermediateFormat(opt.intermediate_format);
+    (*config)->setJobs(opt.map_jobs, opt.reduce_jobs, opt.gen_jobs);
+    (*config)->setMemoryBudget(opt.memory_budget);
+    (*config)->setMapIsolation(opt.isolate_map,
+        opt.map_retries, opt.map_timeout);
+    (*config)->setMultiPage(opt.multi_page);
 
     return config;
 }
@@ -169,6 +202,10 @@ Config::
 shouldVisitTU(
     llvm::StringRef filePath) const noexcept
 {
+    // In umbrella header mode, the only translation
+    // units are the ones synthesized from the headers.
+    if(! publicHeaders_.empty())
+        return true;
     if(inputFileIncludes_.empty())
         return true;
     for(auto const& s : inputFileIncludes_)
@@ -223,5 +260,47 @@ setInputFileIncludes(
         inputFileIncludes_.push_back(normalizePath(s0));
 }
 
+void
+Config::
+setASTManifest(
+    llvm::StringRef filePath)
+{
+    if(filePath.empty())
+    {
+        astManifest_.clear();
+        return;
+    }
+    astManifest_ = normalizePath(filePath).str();
+}
+
+void
+Config::
+setStatsFile(
+    llvm::StringRef filePath)
+{
+    if(filePath.empty())
+    {
+        statsFile_.clear();
+        return;
+    }
+    statsFile_ = normalizePath(filePath).str();
+}
+
+void
+Config::
+setPublicHeaders(
+    std::vector<std::string> const& list)
+{
+    publicHeaders_ = list;
+}
+
+void
+Config::
+setIntermediateFormat(
+    llvm::StringRef format)
+{
+    intermediateFormat_ = format.str();
+}
+
 } // mrdox
 } // clang
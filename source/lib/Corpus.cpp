@@ -9,19 +9,29 @@
 // Official repository: https://github.com/cppalliance/mrdox
 //
 
-#include "ast/FrontendAction.hpp"
 #include "ast/Bitcode.hpp"
-#include "ast/Serialize.hpp"
+#include "ast/Executor.hpp"
+#include "ast/FrontendAction.hpp"
+#include "ast/Codec.hpp"
+#include "ast/MemoryBudget.hpp"
+#include "ast/ParseJavadoc.hpp"
+#include "ast/TUStats.hpp"
+#include "ast/UmbrellaDatabase.hpp"
+#include "Scheduler.hpp"
 #include "meta/Reduce.hpp"
 #include <mrdox/Corpus.hpp>
 #include <mrdox/Error.hpp>
 #include <mrdox/Metadata.hpp>
+#include <mrdox/format/OverloadSet.hpp>
 #include <clang/Tooling/AllTUsExecution.h>
 #include <clang/Tooling/CommonOptionsParser.h>
+#include <llvm/Support/Format.h>
 #include <llvm/Support/Mutex.h>
-#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/xxhash.h>
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 
 //#define NO_ASYNC
 
@@ -34,12 +44,17 @@ struct Corpus::Temps
     std::string s1;
 };
 
+struct Corpus::Overloads
+{
+    llvm::StringMap<ScopeOverloads> map;
+};
+
 // A standalone function to call to merge a vector of infos into one.
 // This assumes that all infos in the vector are of the same type, and will fail
 // if they are different.
 // Dispatch function.
 llvm::Expected<std::unique_ptr<Info>>
-mergeInfos(std::vector<std::unique_ptr<Info>>& Values)
+mergeInfos(std::vector<DecodedInfo>& Values)
 {
     if (Values.empty() || !Values[0])
         return llvm::createStringError(llvm::inconvertibleErrorCode(),
@@ -62,6 +77,18 @@ mergeInfos(std::vector<std::unique_ptr<Info>>& Values)
     }
 }
 
+//------------------------------------------------
+
+Corpus::
+Corpus(
+    Config const& config) noexcept
+    : config_(config)
+{
+}
+
+Corpus::
+~Corpus() = default;
+
 //------------------------------------------------
 //
 // Modifiers
@@ -71,93 +98,225 @@ mergeInfos(std::vector<std::unique_ptr<Info>>& Values)
 llvm::Expected<std::unique_ptr<Corpus>>
 Corpus::
 build(
-    tooling::ToolExecutor& ex,
+    tooling::CompilationDatabase const& db,
     Config const& config,
     Reporter& R)
 {
     std::unique_ptr<Corpus> corpus(new Corpus(config));
+    corpus->scheduler_ = std::make_unique<Scheduler>(config, R);
+
+    // In umbrella header mode the translation units
+    // in the database are replaced with synthetic ones
+    // which include all of the public headers.
+    std::unique_ptr<UmbrellaDatabase> umbrella;
+    if(! config.publicHeaders().empty())
+    {
+        auto result = UmbrellaDatabase::create(db, config, R);
+        if(! result)
+            return result.takeError();
+        umbrella = std::move(*result);
+    }
+    // The statistics only affect the order in which
+    // translation units are mapped and the estimates
+    // of their memory, so a problem with the file
+    // is not an error.
+    TUStats stats;
+    if(! config.statsFile().empty())
+        if(auto err = stats.load(config.statsFile()))
+            R.print("warning: ", toString(std::move(err)));
+    MemoryBudget budget(
+        std::uint64_t(config.memoryBudget()) * 1024 * 1024,
+        corpus->scheduler_->concurrency(Phase::map),
+        stats);
+    TUResults results;
+    // Parsed comments are shared by the translation
+    // units, and dropped once they are all mapped.
+    auto javadocs = std::make_unique<JavadocCache>();
+    Executor ex(umbrella ? *umbrella : db,
+        *corpus->scheduler_, budget, stats, results, config, R);
+    if(umbrella)
+    {
+        for(auto const& file : umbrella->files())
+        {
+            ex.mapVirtualFile(file.path, file.content);
+            budget.setInputSize(file.path, file.inputSize);
+        }
+    }
+
+    auto codec = makeCodec(config);
+    if(! codec)
+        return codec.takeError();
 
     // Traverse the AST for all translation units
-    // and emit serializd bitcode into tool results.
+    // and emit serializd Info into the results.
     // This operation happens ona thread pool.
     if(config.verbose())
         R.print("Mapping declarations");
     if(auto err = ex.execute(
         makeFrontendActionFactory(
-            *ex.getExecutionContext(), config, R),
+            results, budget, *javadocs, **codec, config, R),
         config.ArgAdjuster))
     {
         if(! config.IgnoreMappingFailures)
             return err;
         R.print("warning: mapping failed because ", toString(std::move(err)));
     }
+    javadocs.reset();
+
+    if(config.verbose())
+        budget.report(10, R);
+
+    if(! config.statsFile().empty())
+        if(auto err = stats.save(config.statsFile()))
+            R.print("warning: ", toString(std::move(err)));
 
     // Collect the symbols. Each symbol will have
-    // a vector of one or more bitcodes. These will
-    // be merged later.
+    // a vector of one or more slices. These will
+    // be merged later. The data is not copied,
+    // each element refers to a slice in the data
+    // of the translation unit it came from.
     if(config.verbose())
         R.print("Collecting symbols");
-    using USRToBitcodeType = llvm::StringMap<std::vector<StringRef>>;
+    std::vector<TUData>& TUs = results.results();
+    std::vector<std::unique_ptr<InfoDecoder>> Decoders;
+    Decoders.reserve(TUs.size());
+    struct BlockRef
+    {
+        TUData::Slice const* slice;
+        InfoDecoder* decoder;
+    };
+    using USRToBitcodeType = llvm::StringMap<std::vector<BlockRef>>;
     USRToBitcodeType USRToBitcode;
-    ex.getToolResults()->forEachResult(
-        [&](StringRef Key, StringRef Value)
+    for(auto const& TU : TUs)
+    {
+        auto decoder = (*codec)->makeDecoder(TU, R);
+        if(R.error(decoder, "read ", (*codec)->name()))
+            return makeError("one or more errors occurred");
+        Decoders.emplace_back(std::move(*decoder));
+        for(auto const& slice : TU.index)
         {
-            auto result = USRToBitcode.try_emplace(Key, std::vector<StringRef>());
-            result.first->second.emplace_back(Value);
-        });
+            auto result = USRToBitcode.try_emplace(
+                llvm::toStringRef(slice.id), std::vector<BlockRef>());
+            result.first->second.push_back({
+                &slice, Decoders.back().get() });
+        }
+    }
 
     // First reducing phase (reduce all decls into one info per decl).
     if(config.verbose())
         R.print("Reducing ", USRToBitcode.size(), " declarations");
+    auto const reduceStart = std::chrono::steady_clock::now();
     std::atomic<bool> GotFailure;
     GotFailure = false;
-    // VFALCO Should this concurrency be a command line option?
-    llvm::ThreadPool Pool(llvm::hardware_concurrency(tooling::ExecutorConcurrency));
-    for (USRToBitcodeType::MapEntryTy& Group : USRToBitcode)
-    {
-#ifndef NO_ASYNC
-        Pool.async(
-#endif
-        [&, &MyGroup = Group]()
-        {
-            // One or more Info for the same symbol ID
-            std::vector<std::unique_ptr<Info>> Infos;
 
-            // Each Bitcode can have multiple Infos
-            for (auto& Bitcode : MyGroup.getValue())
-            {
-                llvm::BitstreamCursor Stream(Bitcode);
-                auto infos = readBitcode(Stream, R);
-                if(R.error(infos, "read bitcode"))
-                {
-                    GotFailure = true;
-                    return;
-                }
-                std::move(
-                    infos->begin(),
-                    infos->end(),
-                    std::back_inserter(Infos));
-            }
+    // Merge all of the Info for one symbol. The
+    // decoded Info are only needed until they are
+    // merged, so they are made in the arena.
+    auto reduceGroup = [&](
+        USRToBitcodeType::MapEntryTy& Group,
+        InfoArena& arena)
+    {
+        // One or more Info for the same symbol ID
+        std::vector<DecodedInfo> Infos;
+        Infos.reserve(Group.getValue().size());
 
-            auto merged = mergeInfos(Infos);
-            if(R.error(merged, "merge metadata"))
+        // Each slice holds exactly one Info
+        for (auto& Block : Group.getValue())
+        {
+            auto info = Block.decoder->read(*Block.slice, &arena);
+            if(R.error(info, "read ", (*codec)->name()))
             {
                 GotFailure = true;
                 return;
             }
+            Infos.emplace_back(std::move(*info));
+        }
+
+        auto merged = mergeInfos(Infos);
+        if(R.error(merged, "merge metadata"))
+        {
+            GotFailure = true;
+            return;
+        }
 
-            std::unique_ptr<Info> I(merged.get().release());
-            assert(Group.getKey() == llvm::toStringRef(I->USR));
-            corpus->insert(std::move(I));
+        std::unique_ptr<Info> I(merged.get().release());
+        assert(Group.getKey() == llvm::toStringRef(I->USR));
+        corpus->insert(std::move(I));
+    };
+
+    // Most symbols are declared in a few translation
+    // units, so a task per symbol would spend more
+    // time scheduling than merging. The groups are
+    // batched into chunks by their estimated cost,
+    // which is the size of their data plus a fixed
+    // overhead per Info, so that the chunks can be
+    // balanced across the workers.
+    constexpr std::uint64_t InfoCost = 256;
+    std::vector<USRToBitcodeType::MapEntryTy*> Groups;
+    std::vector<std::uint64_t> Costs;
+    Groups.reserve(USRToBitcode.size());
+    Costs.reserve(USRToBitcode.size());
+    std::uint64_t TotalCost = 0;
+    std::uint64_t DecodedBytes = 0;
+    for (USRToBitcodeType::MapEntryTy& Group : USRToBitcode)
+    {
+        std::uint64_t cost = 0;
+        for (auto const& Block : Group.getValue())
+        {
+            cost += Block.slice->size + InfoCost;
+            DecodedBytes += Block.slice->size;
         }
-#ifdef NO_ASYNC
-        ();
+        Groups.push_back(&Group);
+        Costs.push_back(cost);
+        TotalCost += cost;
+    }
+
+    // Aim for enough chunks per worker that
+    // stealing can even out a bad estimate.
+    std::uint64_t const ChunkCost = std::max<std::uint64_t>(
+        TotalCost / (corpus->scheduler_->concurrency(Phase::reduce) * 16), 1);
+    auto Chunks = makeChunks(Costs, ChunkCost);
+    auto reduceChunk = [&](Chunk const& chunk)
+    {
+        // The decoded Info of each group are destroyed
+        // before it returns, so the arena can be reset
+        // and its memory reused by the next group.
+        InfoArena arena;
+        for (std::size_t i = chunk.first; i < chunk.last; ++i)
+        {
+            reduceGroup(*Groups[i], arena);
+            arena.reset();
+        }
+    };
+#ifndef NO_ASYNC
+    ChunkStats const reduceStats = forEachChunk(*corpus->scheduler_,
+        Phase::reduce, std::move(Chunks), reduceChunk);
 #else
-        );
+    ChunkStats reduceStats;
+    reduceStats.chunks = Chunks.size();
+    for (auto const& chunk : Chunks)
+        reduceChunk(chunk);
 #endif
-    }
 
-    Pool.wait();
+    if(config.verbose())
+    {
+        // Report the throughput of the reduce phase in
+        // terms of the slices which were decoded. The
+        // prologue and tables of each translation unit
+        // are read once, so they are not counted. The
+        // steals and the tail show how evenly the
+        // chunks were spread over the workers.
+        std::chrono::duration<double> const elapsed =
+            std::chrono::steady_clock::now() - reduceStart;
+        double const mb = DecodedBytes / (1024.0 * 1024.0);
+        R.print("Reduced ", llvm::format("%.2f", mb), " MB of ",
+            (*codec)->name(), " in ",
+            llvm::format("%.3f", elapsed.count()), "s (",
+            llvm::format("%.1f", elapsed.count() > 0 ? mb / elapsed.count() : 0.0),
+            " MB/s, ", reduceStats.chunks, " chunks, ",
+            reduceStats.steals, " stolen, tail ",
+            llvm::format("%.3f", reduceStats.tail.count()), "s)");
+    }
 
     if(config.verbose())
         R.print("Collected ", corpus->InfoMap.size(), " symbols.\n");
@@ -175,17 +334,6 @@ build(
     return corpus;
 }
 
-void
-Corpus::
-reportResult(
-    tooling::ExecutionContext& exc,
-    Info const& I)
-{
-    std::string s = serialize(I);
-    exc.reportResult(
-        llvm::toStringRef(I.USR), std::move(s));
-}
-
 //------------------------------------------------
 //
 // Observers
@@ -263,6 +411,31 @@ globalNamespace() const noexcept
     return get<NamespaceInfo>(globalNamespaceID());
 }
 
+std::uint64_t
+Corpus::
+hash(
+    SymbolID const& id) const noexcept
+{
+    std::call_once(hashesOnce_, [this]{ computeHashes(); });
+    auto it = hashes_.find(llvm::toStringRef(id));
+    if(it == hashes_.end())
+        return 0;
+    return it->getValue();
+}
+
+ScopeOverloads const&
+Corpus::
+overloads(
+    SymbolID const& id) const noexcept
+{
+    static ScopeOverloads const empty;
+    std::call_once(overloadsOnce_, [this]{ computeOverloads(); });
+    auto it = overloads_->map.find(llvm::toStringRef(id));
+    if(it == overloads_->map.end())
+        return empty;
+    return it->getValue();
+}
+
 //------------------------------------------------
 //
 // Implementation
@@ -398,6 +571,102 @@ canonicalize(Reporter& R)
     return true;
 }
 
+void
+Corpus::
+computeHashes() const
+{
+    // The hash of the metadata of a symbol is the
+    // hash of its bitcode, which is the same for
+    // the same canonical metadata.
+    std::vector<std::uint64_t> own(allSymbols.size());
+    scheduler_->forEach(Phase::reduce, allSymbols.size(),
+        [&](std::size_t i)
+        {
+            llvm::SmallVector<char, 0> buf;
+            llvm::BitstreamWriter stream(buf);
+            writeBitcode(get<Info>(allSymbols[i]), stream);
+            own[i] = llvm::xxHash64(llvm::StringRef(buf.data(), buf.size()));
+        });
+    hashes_.clear();
+    for(std::size_t i = 0; i < allSymbols.size(); ++i)
+        hashes_[llvm::toStringRef(allSymbols[i])] = own[i];
+
+    // Then each scope takes in the hashes of its
+    // members, from the bottom of the tree up.
+    auto const& global = globalNamespace();
+    hashes_[llvm::toStringRef(global.USR)] =
+        foldHash(global, global.Children);
+}
+
+std::uint64_t
+Corpus::
+foldHash(
+    Info const& I,
+    Scope const& scope) const
+{
+    // This runs within the first call to hash(),
+    // so the hashes are looked up directly.
+    auto const lookup = [this](SymbolID const& id) -> std::uint64_t
+    {
+        auto it = hashes_.find(llvm::toStringRef(id));
+        if(it == hashes_.end())
+            return 0;
+        return it->getValue();
+    };
+    llvm::SmallVector<std::uint64_t, 16> v;
+    v.push_back(lookup(I.USR));
+    for(auto const& ref : scope.Namespaces)
+    {
+        if(auto J = find<NamespaceInfo>(ref.USR))
+            hashes_[llvm::toStringRef(J->USR)] = foldHash(*J, J->Children);
+        v.push_back(lookup(ref.USR));
+    }
+    for(auto const& ref : scope.Records)
+    {
+        if(auto J = find<RecordInfo>(ref.USR))
+            hashes_[llvm::toStringRef(J->USR)] = foldHash(*J, J->Children);
+        v.push_back(lookup(ref.USR));
+    }
+    for(auto const& ref : scope.Functions)
+        v.push_back(lookup(ref.USR));
+    return llvm::xxHash64(llvm::StringRef(
+        reinterpret_cast<char const*>(v.data()),
+        v.size() * sizeof(std::uint64_t)));
+}
+
+void
+Corpus::
+computeOverloads() const
+{
+    std::vector<Info const*> scopes;
+    for(auto const& e : InfoMap)
+    {
+        auto const& I = *e.getValue();
+        if( I.IT == InfoType::IT_namespace ||
+            I.IT == InfoType::IT_record)
+            scopes.push_back(&I);
+    }
+
+    // Each scope is grouped on its own,
+    // then the results are moved into place.
+    std::vector<ScopeOverloads> v(scopes.size());
+    scheduler_->forEach(Phase::reduce, scopes.size(),
+        [&](std::size_t i)
+        {
+            Info const& I = *scopes[i];
+            if(I.IT == InfoType::IT_namespace)
+                v[i] = ScopeOverloads(*this,
+                    static_cast<NamespaceInfo const&>(I).Children);
+            else
+                v[i] = ScopeOverloads(*this,
+                    static_cast<RecordInfo const&>(I).Children);
+        });
+    overloads_ = std::make_unique<Overloads>();
+    for(std::size_t i = 0; i < scopes.size(); ++i)
+        overloads_->map.try_emplace(
+            llvm::toStringRef(scopes[i]->USR), std::move(v[i]));
+}
+
 bool
 Corpus::
 canonicalize(
@@ -0,0 +1,212 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "JobServer.hpp"
+#include <mrdox/Error.hpp>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/Process.h>
+#include <string>
+
+#ifdef LLVM_ON_UNIX
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace clang {
+namespace mrdox {
+
+auto
+JobServer::
+Token::
+operator=(Token&& other) noexcept ->
+    Token&
+{
+    if(this != &other)
+    {
+        if(js_)
+            js_->release(c_);
+        js_ = other.js_;
+        c_ = other.c_;
+        other.js_ = nullptr;
+    }
+    return *this;
+}
+
+JobServer::
+Token::
+~Token()
+{
+    if(js_)
+        js_->release(c_);
+}
+
+//------------------------------------------------
+
+JobServer::
+JobServer(
+    int readFd,
+    int writeFd) noexcept
+    : readFd_(readFd)
+    , writeFd_(writeFd)
+{
+}
+
+JobServer::
+~JobServer()
+{
+#ifdef LLVM_ON_UNIX
+    ::close(readFd_);
+    ::close(writeFd_);
+#endif
+}
+
+llvm::Expected<std::unique_ptr<JobServer>>
+JobServer::
+fromEnvironment()
+{
+    auto makeFlags = llvm::sys::Process::GetEnv("MAKEFLAGS");
+    if(! makeFlags)
+        return nullptr;
+    return fromMakeFlags(*makeFlags);
+}
+
+llvm::Expected<std::unique_ptr<JobServer>>
+JobServer::
+fromMakeFlags(
+    llvm::StringRef makeFlags)
+{
+    // Newer versions of make spell the option
+    // --jobserver-auth, older ones --jobserver-fds.
+    // When both appear the last one wins.
+    llvm::StringRef auth;
+    llvm::SmallVector<llvm::StringRef, 8> args;
+    makeFlags.split(args, ' ', -1, false);
+    for(llvm::StringRef arg : args)
+    {
+        if( arg.consume_front("--jobserver-auth=") ||
+            arg.consume_front("--jobserver-fds="))
+            auth = arg;
+    }
+    if(auth.empty())
+        return nullptr;
+
+#ifdef LLVM_ON_UNIX
+    int readFd;
+    int writeFd;
+    if(auth.consume_front("fifo:"))
+    {
+        std::string const path = auth.str();
+        readFd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if(readFd < 0)
+            return makeError("open the jobserver fifo '", path,
+                "' returned ", std::strerror(errno));
+        writeFd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+        if(writeFd < 0)
+        {
+            int const ec = errno;
+            ::close(readFd);
+            return makeError("open the jobserver fifo '", path,
+                "' returned ", std::strerror(ec));
+        }
+        return std::unique_ptr<JobServer>(
+            new JobServer(readFd, writeFd));
+    }
+
+    auto [readStr, writeStr] = auth.split(',');
+    int parentRead;
+    int parentWrite;
+    if( readStr.getAsInteger(10, parentRead) ||
+        writeStr.getAsInteger(10, parentWrite))
+        return makeError("unknown jobserver '", auth, "'");
+
+    // When make does not consider the command to be
+    // a sub-make it closes the descriptors, which
+    // may then be reused for unrelated files.
+    auto isPipe = [](int fd)
+    {
+        struct stat st;
+        return fd >= 0 &&
+            ::fstat(fd, &st) == 0 &&
+            S_ISFIFO(st.st_mode);
+    };
+    if(! isPipe(parentRead) || ! isPipe(parentWrite))
+        return makeError("the jobserver descriptors ", auth,
+            " are not open; prefix the make rule with '+'");
+
+    // Reopening the pipe gives this process its own
+    // file description, so it can be made non-blocking
+    // without affecting make. Where that is not possible
+    // the read may block, if another process takes the
+    // token between the poll and the read.
+    std::string const readPath = "/dev/fd/" + std::to_string(parentRead);
+    readFd = ::open(readPath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if(readFd < 0)
+        readFd = ::fcntl(parentRead, F_DUPFD_CLOEXEC, 0);
+    if(readFd < 0)
+        return makeError("duplicate the jobserver descriptor returned ",
+            std::strerror(errno));
+    writeFd = ::fcntl(parentWrite, F_DUPFD_CLOEXEC, 0);
+    if(writeFd < 0)
+    {
+        int const ec = errno;
+        ::close(readFd);
+        return makeError("duplicate the jobserver descriptor returned ",
+            std::strerror(ec));
+    }
+    return std::unique_ptr<JobServer>(
+        new JobServer(readFd, writeFd));
+#else
+    return makeError("the jobserver '", auth, "' is not supported on this platform");
+#endif
+}
+
+auto
+JobServer::
+tryAcquire(
+    std::chrono::milliseconds timeout) ->
+        Token
+{
+#ifdef LLVM_ON_UNIX
+    struct pollfd pfd;
+    pfd.fd = readFd_;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int const n = ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+    if(n <= 0 || (pfd.revents & POLLIN) == 0)
+        return Token();
+    char c;
+    if(::read(readFd_, &c, 1) != 1)
+        return Token();
+    return Token(this, c);
+#else
+    return Token();
+#endif
+}
+
+void
+JobServer::
+release(char c) noexcept
+{
+#ifdef LLVM_ON_UNIX
+    // The token must go back even if a
+    // signal interrupts the write.
+    while(::write(writeFd_, &c, 1) < 0 && errno == EINTR)
+    {
+    }
+#endif
+}
+
+} // mrdox
+} // clang
@@ -0,0 +1,131 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_JOBSERVER_HPP
+#define MRDOX_SOURCE_JOBSERVER_HPP
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <chrono>
+#include <memory>
+
+namespace clang {
+namespace mrdox {
+
+/** A client of the GNU make jobserver.
+
+    When mrdox runs inside a parallel make, the
+    parent make passes the location of its job
+    slots in `MAKEFLAGS`. Every process holds one
+    implicit slot, and must read a token from the
+    jobserver before it uses one more thread.
+    Each token is written back when the thread
+    is done, so that the total number of jobs
+    across the build never exceeds `-j`.
+
+    Both the pipe (`--jobserver-auth=R,W`) and
+    the named fifo (`--jobserver-auth=fifo:PATH`)
+    styles are supported, on POSIX systems only.
+*/
+class JobServer
+{
+public:
+    /** A job slot acquired from the jobserver.
+
+        The token is written back when the
+        object is destroyed.
+    */
+    class Token
+    {
+        JobServer* js_ = nullptr;
+        char c_ = 0;
+
+        friend class JobServer;
+
+        Token(JobServer* js, char c) noexcept
+            : js_(js)
+            , c_(c)
+        {
+        }
+
+    public:
+        Token() = default;
+
+        Token(Token&& other) noexcept
+            : js_(other.js_)
+            , c_(other.c_)
+        {
+            other.js_ = nullptr;
+        }
+
+        Token&
+        operator=(Token&& other) noexcept;
+
+        ~Token();
+
+        /** Return true if the token holds a job slot.
+        */
+        explicit
+        operator bool() const noexcept
+        {
+            return js_ != nullptr;
+        }
+    };
+
+    JobServer(JobServer const&) = delete;
+    JobServer& operator=(JobServer const&) = delete;
+
+    ~JobServer();
+
+    /** Return a client for the jobserver named in `MAKEFLAGS`.
+
+        If there is no jobserver, a null pointer is
+        returned. An error is returned when `MAKEFLAGS`
+        names a jobserver which cannot be used, for
+        example because the parent make did not pass
+        the descriptors to this process.
+    */
+    static
+    llvm::Expected<std::unique_ptr<JobServer>>
+    fromEnvironment();
+
+    /** Return a client for the jobserver described by `MAKEFLAGS`.
+
+        @param makeFlags The value of `MAKEFLAGS`.
+    */
+    static
+    llvm::Expected<std::unique_ptr<JobServer>>
+    fromMakeFlags(
+        llvm::StringRef makeFlags);
+
+    /** Wait for a token.
+
+        @return A token, which is empty if none
+        became available within the timeout.
+
+        @param timeout How long to wait.
+    */
+    Token
+    tryAcquire(
+        std::chrono::milliseconds timeout);
+
+private:
+    JobServer(int readFd, int writeFd) noexcept;
+
+    void release(char c) noexcept;
+
+    int readFd_;
+    int writeFd_;
+};
+
+} // mrdox
+} // clang
+
+#endif
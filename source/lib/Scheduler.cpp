@@ -0,0 +1,302 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "Scheduler.hpp"
+#include <clang/Tooling/AllTUsExecution.h>
+#include <llvm/Support/Mutex.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <mutex>
+
+namespace clang {
+namespace mrdox {
+
+namespace {
+
+std::size_t
+resolveJobs(unsigned jobs)
+{
+    if(jobs != 0)
+        return jobs;
+    return llvm::hardware_concurrency(
+        tooling::ExecutorConcurrency).compute_thread_count();
+}
+
+/*  Return the number of threads in the pool.
+    The calling thread is always one of the
+    workers, so it is left out of the count.
+*/
+unsigned
+poolSize(
+    std::size_t const (&limits)[3])
+{
+    std::size_t const n = *std::max_element(
+        std::begin(limits), std::end(limits));
+    return static_cast<unsigned>(std::max<std::size_t>(n, 2) - 1);
+}
+
+} // (anon)
+
+struct Scheduler::Batch
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    llvm::function_ref<void(std::size_t)> f;
+    std::size_t active = 0;
+    bool closed = false;
+};
+
+Scheduler::
+Scheduler(
+    Config const& config,
+    Reporter& R)
+    : limits_{
+        resolveJobs(config.mapJobs()),
+        resolveJobs(config.reduceJobs()),
+        resolveJobs(config.genJobs()) }
+    , pool_(llvm::hardware_concurrency(poolSize(limits_)))
+{
+    auto jobServer = JobServer::fromEnvironment();
+    if(! jobServer)
+    {
+        // Like make itself, fall back to one job
+        // when the jobserver cannot be reached.
+        static std::atomic<bool> warned = false;
+        std::string msg = toString(jobServer.takeError());
+        if(! warned.exchange(true))
+            R.print("warning: ", msg, ", using one job");
+        for(auto& n : limits_)
+            n = 1;
+        return;
+    }
+    jobServer_ = std::move(*jobServer);
+}
+
+Scheduler::
+~Scheduler() = default;
+
+void
+Scheduler::
+run(
+    Phase phase,
+    std::size_t workers,
+    llvm::function_ref<void(std::size_t)> f)
+{
+    workers = std::min(workers, concurrency(phase));
+    if(workers == 0)
+        return;
+    auto batch = std::make_shared<Batch>();
+    batch->f = f;
+    for(std::size_t w = 1; w < workers; ++w)
+        pool_.async(
+            [this, batch, w]
+            {
+                help(batch, w);
+            });
+
+    f(0);
+
+    // Workers which did not start yet will see
+    // that the batch is closed and return at once.
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->closed = true;
+    batch->cv.wait(lock,
+        [&]
+        {
+            return batch->active == 0;
+        });
+}
+
+void
+Scheduler::
+help(
+    std::shared_ptr<Batch> batch,
+    std::size_t worker)
+{
+    // Wait for a token, but give up once the
+    // calling thread has finished the work.
+    JobServer::Token token;
+    while(jobServer_)
+    {
+        {
+            std::lock_guard<std::mutex> lock(batch->mutex);
+            if(batch->closed)
+                return;
+        }
+        token = jobServer_->tryAcquire(
+            std::chrono::milliseconds(50));
+        if(token)
+            break;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        if(batch->closed)
+            return;
+        ++batch->active;
+    }
+    batch->f(worker);
+    {
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        --batch->active;
+    }
+    batch->cv.notify_all();
+}
+
+void
+Scheduler::
+forEach(
+    Phase phase,
+    std::size_t n,
+    llvm::function_ref<void(std::size_t)> f)
+{
+    std::atomic<std::size_t> next = 0;
+    run(phase, n,
+        [&](std::size_t)
+        {
+            for(;;)
+            {
+                std::size_t const i = next++;
+                if(i >= n)
+                    return;
+                f(i);
+            }
+        });
+}
+
+//------------------------------------------------
+
+std::vector<Chunk>
+makeChunks(
+    llvm::ArrayRef<std::uint64_t> costs,
+    std::uint64_t target)
+{
+    std::vector<Chunk> chunks;
+    Chunk batch{ 0, 0, 0 };
+    for(std::size_t i = 0; i < costs.size(); ++i)
+    {
+        if(costs[i] >= target)
+        {
+            if(batch.first != batch.last)
+                chunks.push_back(batch);
+            chunks.push_back({ i, i + 1, costs[i] });
+            batch = { i + 1, i + 1, 0 };
+            continue;
+        }
+        batch.last = i + 1;
+        batch.cost += costs[i];
+        if(batch.cost >= target)
+        {
+            chunks.push_back(batch);
+            batch = { i + 1, i + 1, 0 };
+        }
+    }
+    if(batch.first != batch.last)
+        chunks.push_back(batch);
+    return chunks;
+}
+
+namespace {
+
+/*  The queue of chunks owned by one worker.
+*/
+struct WorkQueue
+{
+    llvm::sys::Mutex mutex;
+    std::deque<Chunk const*> chunks;
+
+    Chunk const*
+    pop()
+    {
+        std::lock_guard<llvm::sys::Mutex> lock(mutex);
+        if(chunks.empty())
+            return nullptr;
+        Chunk const* c = chunks.front();
+        chunks.pop_front();
+        return c;
+    }
+
+    Chunk const*
+    steal()
+    {
+        std::lock_guard<llvm::sys::Mutex> lock(mutex);
+        if(chunks.empty())
+            return nullptr;
+        Chunk const* c = chunks.back();
+        chunks.pop_back();
+        return c;
+    }
+};
+
+} // (anon)
+
+ChunkStats
+forEachChunk(
+    Scheduler& scheduler,
+    Phase phase,
+    std::vector<Chunk> chunks,
+    llvm::function_ref<void(Chunk const&)> f)
+{
+    ChunkStats stats;
+    stats.chunks = chunks.size();
+    if(chunks.empty())
+        return stats;
+
+    // Starting the most expensive chunks first
+    // keeps them from making a long tail.
+    std::stable_sort(chunks.begin(), chunks.end(),
+        [](Chunk const& c0, Chunk const& c1)
+        {
+            return c0.cost > c1.cost;
+        });
+
+    std::size_t const workers = std::min<std::size_t>(
+        scheduler.concurrency(phase), chunks.size());
+    std::vector<WorkQueue> queues(workers);
+    for(std::size_t i = 0; i < chunks.size(); ++i)
+        queues[i % workers].chunks.push_back(&chunks[i]);
+
+    using clock = std::chrono::steady_clock;
+    auto const start = clock::now();
+    std::atomic<std::size_t> steals = 0;
+    std::atomic<clock::rep> tailStart = 0;
+    scheduler.run(phase, workers,
+        [&](std::size_t w)
+        {
+            for(;;)
+            {
+                Chunk const* c = queues[w].pop();
+                for(std::size_t i = 1; ! c && i < workers; ++i)
+                    if((c = queues[(w + i) % workers].steal()))
+                        ++steals;
+                // No chunk is ever added after the
+                // workers start, so once every queue
+                // is empty this worker is done.
+                if(! c)
+                {
+                    clock::rep none = 0;
+                    tailStart.compare_exchange_strong(none,
+                        (clock::now() - start).count());
+                    return;
+                }
+                f(*c);
+            }
+        });
+    stats.steals = steals;
+    stats.tail = clock::now() - start -
+        clock::duration(tailStart.load());
+    return stats;
+}
+
+} // mrdox
+} // clang
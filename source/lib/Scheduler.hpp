@@ -0,0 +1,200 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_SCHEDULER_HPP
+#define MRDOX_SOURCE_SCHEDULER_HPP
+
+#include "JobServer.hpp"
+#include <mrdox/Config.hpp>
+#include <mrdox/Reporter.hpp>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/STLFunctionalExtras.h>
+#include <llvm/Support/ThreadPool.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace clang {
+namespace mrdox {
+
+/** A phase of the work, with its own concurrency limit.
+*/
+enum class Phase
+{
+    map,
+    reduce,
+    generate
+};
+
+/** Runs the work of every phase on one pool of threads.
+
+    The thread which starts a batch of work always
+    takes part in it, and other workers run on the
+    pool. A batch can thus be started from a thread
+    of any pool, including this one, without risking
+    a deadlock. The number of workers in a batch is
+    bounded by the limit for its phase.
+
+    When a GNU make jobserver is available, each
+    worker other than the calling thread must hold
+    a token from the jobserver while it runs.
+*/
+class Scheduler
+{
+    struct Batch;
+
+    std::size_t limits_[3];
+    std::unique_ptr<JobServer> jobServer_;
+    llvm::ThreadPool pool_;
+
+    void help(std::shared_ptr<Batch> batch, std::size_t worker);
+
+public:
+    /** Constructor.
+
+        @param config The configuration which
+        holds the limit for each phase.
+
+        @param R The reporter used to warn when
+        the jobserver cannot be used.
+    */
+    Scheduler(
+        Config const& config,
+        Reporter& R);
+
+    ~Scheduler();
+
+    Scheduler(Scheduler const&) = delete;
+    Scheduler& operator=(Scheduler const&) = delete;
+
+    /** Return the largest number of workers for a phase.
+    */
+    std::size_t
+    concurrency(
+        Phase phase) const noexcept
+    {
+        return limits_[static_cast<int>(phase)];
+    }
+
+    /** Invoke a function on each of a number of workers.
+
+        The function is invoked with the worker
+        number, and worker zero always runs on the
+        calling thread. The other workers may start
+        late or not at all, so the function must be
+        written such that any worker can finish all
+        of the work. This returns once worker zero
+        has returned and no other worker is running.
+
+        @param phase The phase whose limit applies.
+
+        @param workers The number of workers wanted.
+
+        @param f The function to invoke. It may
+        be called concurrently.
+    */
+    void
+    run(
+        Phase phase,
+        std::size_t workers,
+        llvm::function_ref<void(std::size_t)> f);
+
+    /** Invoke a function for every index in a range.
+
+        The indexes are handed out in increasing order.
+
+        @param phase The phase whose limit applies.
+
+        @param n The number of indexes, starting from zero.
+
+        @param f The function to invoke. It may
+        be called concurrently.
+    */
+    void
+    forEach(
+        Phase phase,
+        std::size_t n,
+        llvm::function_ref<void(std::size_t)> f);
+};
+
+/** A contiguous range of work items and their total cost.
+*/
+struct Chunk
+{
+    std::size_t first;
+    std::size_t last;
+    std::uint64_t cost;
+};
+
+/** Partition a sequence of work items into chunks.
+
+    An item whose cost is at least the target
+    is given a chunk of its own. Runs of smaller
+    items are batched into one chunk, until the
+    total cost of the chunk reaches the target.
+
+    @param costs The estimated cost of each item.
+
+    @param target The desired cost of a chunk.
+*/
+std::vector<Chunk>
+makeChunks(
+    llvm::ArrayRef<std::uint64_t> costs,
+    std::uint64_t target);
+
+/** How a set of chunks was processed.
+*/
+struct ChunkStats
+{
+    /** The number of chunks.
+    */
+    std::size_t chunks = 0;
+
+    /** The number of chunks taken from another worker's queue.
+    */
+    std::size_t steals = 0;
+
+    /** The time from when the first worker found
+        every queue empty until the last chunk was done.
+    */
+    std::chrono::duration<double> tail{};
+};
+
+/** Invoke a function for every chunk, on a work-stealing scheduler.
+
+    The chunks are dealt to one queue per worker,
+    largest first. Each worker takes chunks from
+    the front of its own queue, and when it runs
+    dry it steals from the back of the others.
+    This returns after every chunk was processed.
+
+    @param scheduler The scheduler which runs the workers.
+
+    @param phase The phase whose limit applies.
+
+    @param chunks The chunks to process.
+
+    @param f The function to invoke. It may
+    be called concurrently.
+
+    @return How the chunks were processed.
+*/
+ChunkStats
+forEachChunk(
+    Scheduler& scheduler,
+    Phase phase,
+    std::vector<Chunk> chunks,
+    llvm::function_ref<void(Chunk const&)> f);
+
+} // mrdox
+} // clang
+
+#endif
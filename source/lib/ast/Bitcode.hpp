@@ -12,8 +12,10 @@
 #ifndef MRDOX_SOURCE_AST_BITCODE_HPP
 #define MRDOX_SOURCE_AST_BITCODE_HPP
 
+#include "ast/Codec.hpp"
 #include <mrdox/MetadataFwd.hpp>
 #include <mrdox/Reporter.hpp>
+#include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Error.h>
 #include <llvm/Bitstream/BitstreamReader.h>
 #include <llvm/Bitstream/BitstreamWriter.h>
@@ -23,6 +25,48 @@
 namespace clang {
 namespace mrdox {
 
+class BitcodeWriter;
+
+/** Writes the Info from one translation unit to a single stream.
+
+    The stream begins with the signature, the
+    BlockInfo block, and the version block, which
+    together form the prologue. These are followed
+    by one top-level block for each Info, and then
+    by the string and symbol tables which the Info
+    blocks refer to. Every block starts on a 32-bit
+    boundary, so a block may be read in place once
+    the prologue and tables have been read.
+
+    The prologue is emitted once, when the
+    writer is constructed.
+*/
+class TUBitcodeWriter : public InfoEncoder
+{
+public:
+    TUBitcodeWriter();
+    ~TUBitcodeWriter();
+
+    /** Append an Info as a top-level block.
+    */
+    void
+    write(Info const& I) override;
+
+    /** Emit the tables and return the bitcode.
+
+        No more Info may be written afterwards.
+    */
+    TUData
+    release() override;
+
+private:
+    TUData bitcode_;
+    llvm::BitstreamWriter stream_;
+    std::unique_ptr<BitcodeWriter> writer_;
+};
+
+//------------------------------------------------
+
 /** Write an Info variant to the bitstream.
 */
 void
@@ -38,6 +82,49 @@ readBitcode(
     llvm::BitstreamCursor& Stream,
     Reporter& R);
 
+/** The tables shared by the readers of one translation unit.
+
+    The strings refer to the bitcode, which
+    must outlive this object.
+*/
+struct BitcodeTables
+{
+    llvm::BitstreamBlockInfo blockInfo;
+    std::vector<llvm::StringRef> strings;
+    std::vector<SymbolID> symbols;
+};
+
+/** Read the prologue and tables of a translation unit.
+
+    @param bitcode The bitcode to read.
+
+    @param tables The tables to fill in.
+*/
+llvm::Error
+readBitcodeTables(
+    TUData const& bitcode,
+    BitcodeTables& tables,
+    Reporter& R);
+
+/** Return the Info in one top-level block, read in place.
+
+    @param block The bytes returned by
+    @ref TUData::slice.
+
+    @param tables The tables read from the
+    same translation unit. These may be
+    shared by concurrent readers.
+
+    @param arena The arena to make the Info
+    in, or null to allocate it on the heap.
+*/
+llvm::Expected<DecodedInfo>
+readBitcode(
+    llvm::StringRef block,
+    BitcodeTables& tables,
+    InfoArena* arena,
+    Reporter& R);
+
 } // mrdox
 } // clang
 
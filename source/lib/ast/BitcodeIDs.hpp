@@ -20,7 +20,7 @@ namespace mrdox {
 // Current version number of clang-doc bitcode.
 // Should be bumped when removing or changing BlockIds, RecordIds, or
 // BitCodeConstants, though they can be added without breaking it.
-static const unsigned VersionNumber = 3;
+static const unsigned VersionNumber = 4;
 
 struct BitCodeConstants
 {
@@ -28,13 +28,7 @@ struct BitCodeConstants
     static constexpr unsigned SignatureBitSize = 8U;
     static constexpr unsigned SubblockIDSize = 4U;
     static constexpr unsigned BoolSize = 1U;
-    static constexpr unsigned IntSize = 16U;
-    static constexpr unsigned StringLengthSize = 16U;
-    static constexpr unsigned FilenameLengthSize = 16U;
-    static constexpr unsigned LineNumberSize = 32U;
-    static constexpr unsigned ReferenceTypeSize = 8U;
-    static constexpr unsigned USRLengthSize = 6U;
-    static constexpr unsigned USRBitLengthSize = 8U;
+    static constexpr unsigned VBRSize = 6U;
     static constexpr unsigned USRHashSize = 20;
     static constexpr unsigned char Signature[4] = {'D', 'O', 'C', 'S'};
 };
@@ -65,6 +59,8 @@ enum BlockId
     BI_TEMPLATE_SPECIALIZATION_BLOCK_ID,
     BI_TEMPLATE_PARAM_BLOCK_ID,
     BI_TYPEDEF_BLOCK_ID,
+    BI_STRING_TABLE_BLOCK_ID,
+    BI_SYMBOL_TABLE_BLOCK_ID,
     BI_LAST,
     BI_FIRST = BI_VERSION_BLOCK_ID
 };
@@ -125,6 +121,9 @@ enum RecordId
     TYPEDEF_NAME,
     TYPEDEF_DEFLOCATION,
     TYPEDEF_IS_USING,
+    STRING_TABLE_SIZES,
+    STRING_TABLE_DATA,
+    SYMBOL_TABLE_DATA,
     RI_LAST,
     RI_FIRST = VERSION
 };
@@ -132,6 +131,69 @@ enum RecordId
 static constexpr unsigned BlockIdCount = BI_LAST - BI_FIRST;
 static constexpr unsigned RecordIdCount = RI_LAST - RI_FIRST;
 
+/** How the value of a record refers to the tables of the stream.
+
+    Strings and symbol IDs are stored once per
+    stream in the string table and symbol table
+    blocks, and records hold an index into them.
+*/
+enum class RecordRef
+{
+    none,
+    string,     // [index]
+    symbol,     // [index]
+    location    // [line, isFileInRootDir, filename index]
+};
+
+inline
+constexpr
+RecordRef
+getRecordRef(unsigned ID) noexcept
+{
+    switch(ID)
+    {
+    case JAVADOC_NODE_STRING:
+    case FIELD_TYPE_NAME:
+    case FIELD_DEFAULT_VALUE:
+    case MEMBER_TYPE_NAME:
+    case NAMESPACE_NAME:
+    case NAMESPACE_PATH:
+    case ENUM_NAME:
+    case ENUM_VALUE_NAME:
+    case ENUM_VALUE_VALUE:
+    case ENUM_VALUE_EXPR:
+    case RECORD_NAME:
+    case RECORD_PATH:
+    case BASE_RECORD_NAME:
+    case BASE_RECORD_PATH:
+    case FUNCTION_NAME:
+    case REFERENCE_NAME:
+    case REFERENCE_PATH:
+    case TEMPLATE_PARAM_CONTENTS:
+    case TYPEDEF_NAME:
+        return RecordRef::string;
+    case NAMESPACE_USR:
+    case ENUM_USR:
+    case RECORD_USR:
+    case BASE_RECORD_USR:
+    case FUNCTION_USR:
+    case REFERENCE_USR:
+    case TEMPLATE_SPECIALIZATION_OF:
+    case TYPEDEF_USR:
+        return RecordRef::symbol;
+    case ENUM_DEFLOCATION:
+    case ENUM_LOCATION:
+    case RECORD_DEFLOCATION:
+    case RECORD_LOCATION:
+    case FUNCTION_DEFLOCATION:
+    case FUNCTION_LOCATION:
+    case TYPEDEF_DEFLOCATION:
+        return RecordRef::location;
+    default:
+        return RecordRef::none;
+    }
+}
+
 // Identifiers for differentiating between subblocks
 enum class FieldId
 {
@@ -9,6 +9,7 @@
 // Official repository: https://github.com/cppalliance/mrdox
 //
 
+#include "Bitcode.hpp"
 #include "BitcodeIDs.hpp"
 #include "ast/ParseJavadoc.hpp"
 #include <mrdox/Error.hpp>
@@ -19,6 +20,7 @@
 #include <llvm/ADT/Optional.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/Bitstream/BitstreamReader.h>
+#include <cstring>
 
 namespace clang {
 namespace mrdox {
@@ -33,7 +35,9 @@ namespace {
 //
 //------------------------------------------------
 
-using Record = llvm::SmallVector<uint64_t, 1024>;
+// Blobs are returned as references into the
+// stream, so records only hold a few integers.
+using Record = llvm::SmallVector<uint64_t, 64>;
 
 // This implements decode for SmallString.
 llvm::Error
@@ -613,9 +617,13 @@ class BitcodeReader
 public:
     BitcodeReader(
         llvm::BitstreamCursor& Stream,
-        Reporter& R)
+        Reporter& R,
+        BitcodeTables* tables = nullptr,
+        InfoArena* arena = nullptr)
         : R_(R)
         , Stream(Stream)
+        , tables_(tables)
+        , arena_(arena)
     {
     }
 
@@ -624,6 +632,21 @@ public:
         std::vector<std::unique_ptr<Info>>>
     getInfos();
 
+    // Read the Info in the next top-level block.
+    llvm::Expected<DecodedInfo>
+    getInfo();
+
+    // Read a prologue containing only the
+    // BlockInfo and version blocks.
+    llvm::Error
+    readPrologue(
+        llvm::BitstreamBlockInfo& blockInfo);
+
+    // Read the string and symbol table blocks.
+    llvm::Error
+    readTables(
+        BitcodeTables& tables);
+
 private:
     enum class Cursor
     {
@@ -640,13 +663,15 @@ private:
 
         Calls createInfo after casting.
     */
-    llvm::Expected<std::unique_ptr<Info>>
+    llvm::Expected<DecodedInfo>
     readBlockToInfo(unsigned ID);
 
     /** Return T from reading the stream.
+
+        The T is made in the arena, if there is one.
     */
     template <typename T>
-    llvm::Expected<std::unique_ptr<Info>>
+    llvm::Expected<DecodedInfo>
     createInfo(unsigned ID);
 
     /** Read a single block.
@@ -702,6 +727,12 @@ private:
         llvm::StringRef Blob, TemplateParamInfo* I);
     llvm::Error parseRecord(Record const& R, unsigned ID,
         llvm::StringRef Blob, Javadoc* I);
+    llvm::Error parseRecord(Record const& R, unsigned ID,
+        llvm::StringRef Blob, BitcodeTables* I);
+
+    // Replace the indexes in a record with the
+    // strings and symbols they refer to.
+    llvm::Error resolveRecord(unsigned ID, llvm::StringRef& Blob);
 
     struct CurrentNodeList
     {
@@ -751,6 +782,9 @@ private:
     Reporter& R_;
     llvm::BitstreamCursor &Stream;
     llvm::Optional<llvm::BitstreamBlockInfo> BlockInfo;
+    BitcodeTables* tables_ = nullptr;
+    InfoArena* arena_ = nullptr;
+    Record record_;
     FieldId CurrentReferenceField;
     Javadoc* javadoc_ = nullptr;
     CurrentNodeList* nodes_ = nullptr;
@@ -768,9 +802,14 @@ getInfos()
     if (auto Err = validateStream())
         return std::move(Err);
 
-    // Read the top level blocks.
+    // The tables follow the Info blocks, so the
+    // first pass skips the Info blocks to find them.
+    BitcodeTables tables;
+    tables_ = &tables;
+    llvm::Optional<uint64_t> InfoStart;
     while (!Stream.AtEndOfStream())
     {
+        uint64_t const BlockStart = Stream.GetCurrentBitNo();
         Expected<unsigned> MaybeCode = Stream.ReadCode();
         if (!MaybeCode)
             return MaybeCode.takeError();
@@ -797,13 +836,16 @@ getInfos()
         case BI_FUNCTION_BLOCK_ID:
         case BI_ENUM_BLOCK_ID:
         case BI_TYPEDEF_BLOCK_ID:
-        {
-            auto InfoOrErr = readBlockToInfo(ID);
-            if (!InfoOrErr)
-                return InfoOrErr.takeError();
-            Infos.emplace_back(std::move(InfoOrErr.get()));
+            if (!InfoStart)
+                InfoStart = BlockStart;
+            if (auto Err = Stream.SkipBlock())
+                return std::move(Err);
+            continue;
+        case BI_STRING_TABLE_BLOCK_ID:
+        case BI_SYMBOL_TABLE_BLOCK_ID:
+            if (auto Err = readBlock(ID, tables_))
+                return std::move(Err);
             continue;
-        }
         case BI_VERSION_BLOCK_ID:
             if (auto Err = readBlock(ID, VersionNumber))
                 return std::move(Err);
@@ -820,9 +862,129 @@ getInfos()
             continue;
         }
     }
+    if (!InfoStart)
+        return std::move(Infos);
+
+    // Read the Info blocks.
+    if (auto Err = Stream.JumpToBit(*InfoStart))
+        return std::move(Err);
+    while (!Stream.AtEndOfStream())
+    {
+        Expected<unsigned> MaybeCode = Stream.ReadCode();
+        if (!MaybeCode)
+            return MaybeCode.takeError();
+        if (MaybeCode.get() != llvm::bitc::ENTER_SUBBLOCK)
+            return makeError("no blocks in input");
+        Expected<unsigned> MaybeID = Stream.ReadSubBlockID();
+        if (!MaybeID)
+            return MaybeID.takeError();
+        unsigned ID = MaybeID.get();
+        switch (ID)
+        {
+        case BI_NAMESPACE_BLOCK_ID:
+        case BI_RECORD_BLOCK_ID:
+        case BI_FUNCTION_BLOCK_ID:
+        case BI_ENUM_BLOCK_ID:
+        case BI_TYPEDEF_BLOCK_ID:
+        {
+            // There is no arena, so the Info is on the heap.
+            auto InfoOrErr = readBlockToInfo(ID);
+            if (!InfoOrErr)
+                return InfoOrErr.takeError();
+            Infos.emplace_back(InfoOrErr.get().release());
+            continue;
+        }
+        default:
+            if (auto Err = Stream.SkipBlock())
+                return std::move(Err);
+            continue;
+        }
+    }
     return std::move(Infos);
 }
 
+llvm::Expected<DecodedInfo>
+BitcodeReader::
+getInfo()
+{
+    Expected<unsigned> MaybeCode = Stream.ReadCode();
+    if (!MaybeCode)
+        return MaybeCode.takeError();
+    if (MaybeCode.get() != llvm::bitc::ENTER_SUBBLOCK)
+        return makeError("no blocks in input");
+    Expected<unsigned> MaybeID = Stream.ReadSubBlockID();
+    if (!MaybeID)
+        return MaybeID.takeError();
+    return readBlockToInfo(MaybeID.get());
+}
+
+llvm::Error
+BitcodeReader::
+readPrologue(
+    llvm::BitstreamBlockInfo& blockInfo)
+{
+    if (auto Err = validateStream())
+        return Err;
+    while (!Stream.AtEndOfStream())
+    {
+        Expected<unsigned> MaybeCode = Stream.ReadCode();
+        if (!MaybeCode)
+            return MaybeCode.takeError();
+        if (MaybeCode.get() != llvm::bitc::ENTER_SUBBLOCK)
+            return makeError("no blocks in input");
+        Expected<unsigned> MaybeID = Stream.ReadSubBlockID();
+        if (!MaybeID)
+            return MaybeID.takeError();
+        switch (MaybeID.get())
+        {
+        case BI_VERSION_BLOCK_ID:
+            if (auto Err = readBlock(MaybeID.get(), VersionNumber))
+                return Err;
+            continue;
+        case llvm::bitc::BLOCKINFO_BLOCK_ID:
+            if (auto Err = readBlockInfoBlock())
+                return Err;
+            continue;
+        default:
+            return makeError("invalid block in prologue");
+        }
+    }
+    if (!BlockInfo)
+        return makeError("missing BlockInfoBlock");
+    blockInfo = std::move(*BlockInfo);
+    return llvm::Error::success();
+}
+
+llvm::Error
+BitcodeReader::
+readTables(
+    BitcodeTables& tables)
+{
+    tables_ = &tables;
+    while (!Stream.AtEndOfStream())
+    {
+        Expected<unsigned> MaybeCode = Stream.ReadCode();
+        if (!MaybeCode)
+            return MaybeCode.takeError();
+        if (MaybeCode.get() != llvm::bitc::ENTER_SUBBLOCK)
+            return makeError("no blocks in input");
+        Expected<unsigned> MaybeID = Stream.ReadSubBlockID();
+        if (!MaybeID)
+            return MaybeID.takeError();
+        switch (MaybeID.get())
+        {
+        case BI_STRING_TABLE_BLOCK_ID:
+        case BI_SYMBOL_TABLE_BLOCK_ID:
+            if (auto Err = readBlock(MaybeID.get(), tables_))
+                return Err;
+            continue;
+        default:
+            return makeError("invalid block in tables");
+        }
+    }
+    return llvm::Error::success();
+}
+
 //------------------------------------------------
 
 llvm::Error
@@ -859,7 +1021,7 @@ readBlockInfoBlock()
     return llvm::Error::success();
 }
 
-llvm::Expected<std::unique_ptr<Info>>
+llvm::Expected<DecodedInfo>
 BitcodeReader::
 readBlockToInfo(
     unsigned ID)
@@ -882,14 +1044,14 @@ readBlockToInfo(
 }
 
 template <typename T>
-llvm::Expected<std::unique_ptr<Info>>
+llvm::Expected<DecodedInfo>
 BitcodeReader::
 createInfo(unsigned ID)
 {
-    std::unique_ptr<Info> I = std::make_unique<T>();
+    DecodedInfo I = makeDecodedInfo<T>(arena_);
     if (auto Err = readBlock(ID, static_cast<T*>(I.get())))
         return std::move(Err);
-    return std::unique_ptr<Info>{std::move(I)};
+    return std::move(I);
 }
 
 //------------------------------------------------
@@ -1138,7 +1300,9 @@ readSubBlock(
         return llvm::Error::success();
     }
     default:
-        return makeError("invalid subblock type");
+        // Skip blocks which are unknown to this
+        // version of the reader without decoding them.
+        return Stream.SkipBlock();
     }
 }
 
@@ -1150,12 +1314,16 @@ readRecord(
     unsigned ID,
     T I)
 {
-    Record R;
+    // The scratch record is reused, because
+    // parseRecord never reads another record.
+    record_.clear();
     llvm::StringRef Blob;
-    llvm::Expected<unsigned> MaybeRecID = Stream.readRecord(ID, R, &Blob);
+    llvm::Expected<unsigned> MaybeRecID = Stream.readRecord(ID, record_, &Blob);
     if (!MaybeRecID)
         return MaybeRecID.takeError();
-    return parseRecord(R, MaybeRecID.get(), Blob, I);
+    if (auto Err = resolveRecord(MaybeRecID.get(), Blob))
+        return Err;
+    return parseRecord(record_, MaybeRecID.get(), Blob, I);
 }
 
 template<>
@@ -1165,12 +1333,61 @@ readRecord(
     unsigned ID,
     Reference* I)
 {
-    Record R;
+    // The scratch record is reused, because
+    // parseRecord never reads another record.
+    record_.clear();
     llvm::StringRef Blob;
-    llvm::Expected<unsigned> MaybeRecID = Stream.readRecord(ID, R, &Blob);
+    llvm::Expected<unsigned> MaybeRecID = Stream.readRecord(ID, record_, &Blob);
     if (!MaybeRecID)
         return MaybeRecID.takeError();
-    return parseRecord(R, MaybeRecID.get(), Blob, I, CurrentReferenceField);
+    if (auto Err = resolveRecord(MaybeRecID.get(), Blob))
+        return Err;
+    return parseRecord(record_, MaybeRecID.get(), Blob, I, CurrentReferenceField);
+}
+
+llvm::Error
+BitcodeReader::
+resolveRecord(
+    unsigned ID,
+    llvm::StringRef& Blob)
+{
+    auto const getString = [&](uint64_t i) -> llvm::Error
+    {
+        if (!tables_ || i >= tables_->strings.size())
+            return makeError("invalid string index");
+        Blob = tables_->strings[i];
+        return llvm::Error::success();
+    };
+
+    // Records are rewritten to the form in which
+    // strings are blobs and symbols are arrays.
+    switch (getRecordRef(ID))
+    {
+    case RecordRef::none:
+        return llvm::Error::success();
+    case RecordRef::string:
+        if (record_.size() != 1)
+            return makeError("invalid string record");
+        return getString(record_[0]);
+    case RecordRef::location:
+        if (record_.size() != 3)
+            return makeError("invalid location record");
+        return getString(record_[2]);
+    case RecordRef::symbol:
+    {
+        if (record_.size() != 1)
+            return makeError("invalid symbol record");
+        uint64_t const i = record_[0];
+        if (!tables_ || i >= tables_->symbols.size())
+            return makeError("invalid symbol index");
+        SymbolID const& id = tables_->symbols[i];
+        record_.clear();
+        record_.push_back(id.size());
+        record_.append(id.begin(), id.end());
+        return llvm::Error::success();
+    }
+    }
+    return makeError("invalid record");
 }
 
 //------------------------------------------------
@@ -1476,6 +1693,52 @@ parseRecord(
     return makeError("invalid field for TemplateParamInfo");
 }
 
+llvm::Error
+BitcodeReader::
+parseRecord(
+    Record const& R,
+    unsigned ID,
+    llvm::StringRef Blob,
+    BitcodeTables* I)
+{
+    switch (ID)
+    {
+    case STRING_TABLE_SIZES:
+        // Each string refers to the data record which follows.
+        I->strings.clear();
+        I->strings.reserve(R.size());
+        for (auto size : R)
+            I->strings.emplace_back(nullptr, size);
+        return llvm::Error::success();
+    case STRING_TABLE_DATA:
+    {
+        char const* p = Blob.data();
+        char const* const end = Blob.data() + Blob.size();
+        for (auto& str : I->strings)
+        {
+            if (static_cast<std::size_t>(end - p) < str.size())
+                return makeError("string table is too short");
+            str = llvm::StringRef(p, str.size());
+            p += str.size();
+        }
+        if (p != end)
+            return makeError("string table is too long");
+        return llvm::Error::success();
+    }
+    case SYMBOL_TABLE_DATA:
+    {
+        if (Blob.size() % BitCodeConstants::USRHashSize != 0)
+            return makeError("invalid symbol table size");
+        I->symbols.resize(Blob.size() / BitCodeConstants::USRHashSize);
+        if (!I->symbols.empty())
+            std::memcpy(I->symbols.data(), Blob.data(), Blob.size());
+        return llvm::Error::success();
+    }
+    default:
+        return makeError("invalid field for the tables");
+    }
+}
+
 llvm::Error
 BitcodeReader::
 parseRecord(
@@ -1684,5 +1947,45 @@ readBitcode(
     return reader.getInfos();
 }
 
+llvm::Error
+readBitcodeTables(
+    TUData const& bitcode,
+    BitcodeTables& tables,
+    Reporter& R)
+{
+    // The prologue ends where the first
+    // Info block, or else the tables, begin.
+    std::uint32_t const prologueSize =
+        bitcode.index.empty() ?
+            bitcode.tablesOffset :
+            bitcode.index.front().offset;
+    {
+        llvm::BitstreamCursor Stream(llvm::StringRef(
+            bitcode.data.data(), prologueSize));
+        BitcodeReader reader(Stream, R);
+        if (auto Err = reader.readPrologue(tables.blockInfo))
+            return Err;
+    }
+    llvm::BitstreamCursor Stream(llvm::StringRef(
+        bitcode.data.data() + bitcode.tablesOffset,
+        bitcode.data.size() - bitcode.tablesOffset));
+    Stream.setBlockInfo(&tables.blockInfo);
+    BitcodeReader reader(Stream, R);
+    return reader.readTables(tables);
+}
+
+llvm::Expected<DecodedInfo>
+readBitcode(
+    llvm::StringRef block,
+    BitcodeTables& tables,
+    InfoArena* arena,
+    Reporter& R)
+{
+    llvm::BitstreamCursor Stream(block);
+    Stream.setBlockInfo(&tables.blockInfo);
+    BitcodeReader reader(Stream, R, &tables, arena);
+    return reader.getInfo();
+}
+
 } // mrdox
 } // clang
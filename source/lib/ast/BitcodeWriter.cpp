@@ -9,10 +9,14 @@
 // Official repository: https://github.com/cppalliance/mrdox
 //
 
+#include "Bitcode.hpp"
 #include "BitcodeWriter.hpp"
 #include "ast/ParseJavadoc.hpp"
 #include <mrdox/Metadata.hpp>
 #include <llvm/ADT/IndexedMap.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <cstring>
 #include <initializer_list>
 
 namespace clang {
@@ -64,57 +68,66 @@ static void IntAbbrev(
     std::shared_ptr<llvm::BitCodeAbbrev>& Abbrev)
 {
     AbbrevGen(Abbrev, {
-        // 0. Fixed-size integer
+        // 0. Variable-size integer
         llvm::BitCodeAbbrevOp(
-            llvm::BitCodeAbbrevOp::Fixed,
-            BitCodeConstants::IntSize) });
+            llvm::BitCodeAbbrevOp::VBR,
+            BitCodeConstants::VBRSize) });
 }
 
 static void SymbolIDAbbrev(
     std::shared_ptr<llvm::BitCodeAbbrev>& Abbrev)
 {
     AbbrevGen(Abbrev, {
-        // 0. Fixed-size integer (length of the sha1'd USR)
-        llvm::BitCodeAbbrevOp(
-            llvm::BitCodeAbbrevOp::Fixed,
-            BitCodeConstants::USRLengthSize),
-        // 1. Fixed-size array of Char6 (USR)
-        llvm::BitCodeAbbrevOp(llvm::BitCodeAbbrevOp::Array),
+        // 0. Index into the symbol table
         llvm::BitCodeAbbrevOp(
-            llvm::BitCodeAbbrevOp::Fixed,
-            BitCodeConstants::USRBitLengthSize) });
+            llvm::BitCodeAbbrevOp::VBR,
+            BitCodeConstants::VBRSize) });
 }
 
 static void StringAbbrev(
     std::shared_ptr<llvm::BitCodeAbbrev>& Abbrev)
 {
     AbbrevGen(Abbrev, {
-        // 0. Fixed-size integer (length of the following string)
+        // 0. Index into the string table
         llvm::BitCodeAbbrevOp(
-            llvm::BitCodeAbbrevOp::Fixed,
-            BitCodeConstants::StringLengthSize),
-        // 1. The string blob
-        llvm::BitCodeAbbrevOp(llvm::BitCodeAbbrevOp::Blob) });
+            llvm::BitCodeAbbrevOp::VBR,
+            BitCodeConstants::VBRSize) });
 }
 
-// Assumes that the file will not have more than 65535 lines.
 static void LocationAbbrev(
     std::shared_ptr<llvm::BitCodeAbbrev>& Abbrev)
 {
     AbbrevGen(Abbrev, {
-        // 0. Fixed-size integer (line number)
+        // 0. Variable-size integer (line number)
         llvm::BitCodeAbbrevOp(
-            llvm::BitCodeAbbrevOp::Fixed,
-            BitCodeConstants::LineNumberSize),
+            llvm::BitCodeAbbrevOp::VBR,
+            BitCodeConstants::VBRSize),
         // 1. Boolean (IsFileInRootDir)
         llvm::BitCodeAbbrevOp(
             llvm::BitCodeAbbrevOp::Fixed,
             BitCodeConstants::BoolSize),
-        // 2. Fixed-size integer (length of the following string (filename))
+        // 2. Index into the string table (filename)
         llvm::BitCodeAbbrevOp(
-            llvm::BitCodeAbbrevOp::Fixed,
-            BitCodeConstants::StringLengthSize),
-        // 3. The string blob
+            llvm::BitCodeAbbrevOp::VBR,
+            BitCodeConstants::VBRSize) });
+}
+
+static void ArrayAbbrev(
+    std::shared_ptr<llvm::BitCodeAbbrev>& Abbrev)
+{
+    AbbrevGen(Abbrev, {
+        // 0. Array of variable-size integers
+        llvm::BitCodeAbbrevOp(llvm::BitCodeAbbrevOp::Array),
+        llvm::BitCodeAbbrevOp(
+            llvm::BitCodeAbbrevOp::VBR,
+            BitCodeConstants::VBRSize) });
+}
+
+static void BlobAbbrev(
+    std::shared_ptr<llvm::BitCodeAbbrev>& Abbrev)
+{
+    AbbrevGen(Abbrev, {
+        // 0. The blob
         llvm::BitCodeAbbrevOp(llvm::BitCodeAbbrevOp::Blob) });
 }
 
@@ -163,7 +176,9 @@ BlockIdNameMap = []()
         {BI_REFERENCE_BLOCK_ID, "ReferenceBlock"},
         {BI_TEMPLATE_BLOCK_ID, "TemplateBlock"},
         {BI_TEMPLATE_SPECIALIZATION_BLOCK_ID, "TemplateSpecializationBlock"},
-        {BI_TEMPLATE_PARAM_BLOCK_ID, "TemplateParamBlock"} };
+        {BI_TEMPLATE_PARAM_BLOCK_ID, "TemplateParamBlock"},
+        {BI_STRING_TABLE_BLOCK_ID, "StringTableBlock"},
+        {BI_SYMBOL_TABLE_BLOCK_ID, "SymbolTableBlock"} };
     assert(Inits.size() == BlockIdCount);
     for (const auto& Init : Inits)
         BlockIdNameMap[Init.first] = Init.second;
@@ -232,7 +247,10 @@ RecordIdNameMap = []()
         {TYPEDEF_USR, {"USR", &SymbolIDAbbrev}},
         {TYPEDEF_NAME, {"Name", &StringAbbrev}},
         {TYPEDEF_DEFLOCATION, {"DefLocation", &LocationAbbrev}},
-        {TYPEDEF_IS_USING, {"IsUsing", &BoolAbbrev}} };
+        {TYPEDEF_IS_USING, {"IsUsing", &BoolAbbrev}},
+        {STRING_TABLE_SIZES, {"Sizes", &ArrayAbbrev}},
+        {STRING_TABLE_DATA, {"Data", &BlobAbbrev}},
+        {SYMBOL_TABLE_DATA, {"Data", &BlobAbbrev}} };
     assert(Inits.size() == RecordIdCount);
     for (const auto& Init : Inits)
     {
@@ -298,7 +316,10 @@ RecordsByBlock{
     // Template Blocks.
     {BI_TEMPLATE_BLOCK_ID, {}},
         {BI_TEMPLATE_PARAM_BLOCK_ID, {TEMPLATE_PARAM_CONTENTS}},
-        {BI_TEMPLATE_SPECIALIZATION_BLOCK_ID, {TEMPLATE_SPECIALIZATION_OF}}
+        {BI_TEMPLATE_SPECIALIZATION_BLOCK_ID, {TEMPLATE_SPECIALIZATION_OF}},
+    // Table Blocks.
+    {BI_STRING_TABLE_BLOCK_ID, {STRING_TABLE_SIZES, STRING_TABLE_DATA}},
+    {BI_SYMBOL_TABLE_BLOCK_ID, {SYMBOL_TABLE_DATA}}
 };
 
 //------------------------------------------------
@@ -376,6 +397,42 @@ emitVersionBlock()
     emitRecord(VersionNumber, VERSION);
 }
 
+void
+BitcodeWriter::
+emitTableBlocks()
+{
+    {
+        StreamSubBlockGuard Block(Stream, BI_STRING_TABLE_BLOCK_ID);
+        prepRecordData(STRING_TABLE_SIZES);
+        std::size_t size = 0;
+        for(auto const& Str : Strings)
+        {
+            Record.push_back(Str.size());
+            size += Str.size();
+        }
+        Stream.EmitRecordWithAbbrev(Abbrevs.get(STRING_TABLE_SIZES), Record);
+        llvm::SmallString<0> Data;
+        Data.reserve(size);
+        for(auto const& Str : Strings)
+            Data.append(Str);
+        prepRecordData(STRING_TABLE_DATA);
+        Stream.EmitRecordWithBlob(Abbrevs.get(STRING_TABLE_DATA), Record, Data);
+    }
+    {
+        // Symbols are stored in order of their index.
+        StreamSubBlockGuard Block(Stream, BI_SYMBOL_TABLE_BLOCK_ID);
+        llvm::SmallString<0> Data;
+        Data.resize(SymbolIndex.size() * BitCodeConstants::USRHashSize);
+        for(auto const& entry : SymbolIndex)
+            std::memcpy(
+                Data.data() + entry.getValue() * BitCodeConstants::USRHashSize,
+                entry.getKey().data(),
+                BitCodeConstants::USRHashSize);
+        prepRecordData(SYMBOL_TABLE_DATA);
+        Stream.EmitRecordWithBlob(Abbrevs.get(SYMBOL_TABLE_DATA), Record, Data);
+    }
+}
+
 //------------------------------------------------
 
 // Block emission
@@ -762,11 +819,10 @@ emitRecord(
     assert(RecordIdNameMap[ID] && "Unknown RecordId.");
     assert(RecordIdNameMap[ID].Abbrev == &SymbolIDAbbrev &&
         "Abbrev type mismatch.");
+    assert(getRecordRef(ID) == RecordRef::symbol);
     if (!prepRecordData(ID, Sym != EmptySID))
         return;
-    assert(Sym.size() == 20);
-    Record.push_back(Sym.size());
-    Record.append(Sym.begin(), Sym.end());
+    Record.push_back(getSymbolIndex(Sym));
     Stream.EmitRecordWithAbbrev(Abbrevs.get(ID), Record);
 }
 
@@ -778,11 +834,11 @@ emitRecord(
     assert(RecordIdNameMap[ID] && "Unknown RecordId.");
     assert(RecordIdNameMap[ID].Abbrev == &StringAbbrev &&
         "Abbrev type mismatch.");
+    assert(getRecordRef(ID) == RecordRef::string);
     if (!prepRecordData(ID, !Str.empty()))
         return;
-    assert(Str.size() < (1U << BitCodeConstants::StringLengthSize));
-    Record.push_back(Str.size());
-    Stream.EmitRecordWithBlob(Abbrevs.get(ID), Record, Str);
+    Record.push_back(getStringIndex(Str));
+    Stream.EmitRecordWithAbbrev(Abbrevs.get(ID), Record);
 }
 
 void
@@ -793,15 +849,13 @@ emitRecord(
     assert(RecordIdNameMap[ID] && "Unknown RecordId.");
     assert(RecordIdNameMap[ID].Abbrev == &LocationAbbrev &&
         "Abbrev type mismatch.");
+    assert(getRecordRef(ID) == RecordRef::location);
     if (!prepRecordData(ID, true))
         return;
-    // FIXME: Assert that the line number
-    // is of the appropriate size.
     Record.push_back(Loc.LineNumber);
-    assert(Loc.Filename.size() < (1U << BitCodeConstants::StringLengthSize));
     Record.push_back(Loc.IsFileInRootDir);
-    Record.push_back(Loc.Filename.size());
-    Stream.EmitRecordWithBlob(Abbrevs.get(ID), Record, Loc.Filename);
+    Record.push_back(getStringIndex(Loc.Filename));
+    Stream.EmitRecordWithAbbrev(Abbrevs.get(ID), Record);
 }
 
 void
@@ -826,7 +880,6 @@ emitRecord(
     assert(RecordIdNameMap[ID].Abbrev == &IntAbbrev && "Abbrev type mismatch.");
     if (!prepRecordData(ID, Val))
         return;
-    // FIXME: Assert that the integer is of the appropriate size.
     Record.push_back(Val);
     Stream.EmitRecordWithAbbrev(Abbrevs.get(ID), Record);
 }
@@ -840,7 +893,6 @@ emitRecord(
     assert(RecordIdNameMap[ID].Abbrev == &IntAbbrev && "Abbrev type mismatch.");
     if (!prepRecordData(ID, Val))
         return;
-    assert(Val < (1U << BitCodeConstants::IntSize));
     Record.push_back(Val);
     Stream.EmitRecordWithAbbrev(Abbrevs.get(ID), Record);
 }
@@ -853,6 +905,27 @@ emitRecord(
     // VFALCO What's going on here? Missing code?
 }
 
+unsigned
+BitcodeWriter::
+getStringIndex(
+    llvm::StringRef Str)
+{
+    auto result = StringIndex.try_emplace(Str, Strings.size());
+    if(result.second)
+        Strings.push_back(result.first->getKey());
+    return result.first->getValue();
+}
+
+unsigned
+BitcodeWriter::
+getSymbolIndex(
+    SymbolID const& Sym)
+{
+    auto result = SymbolIndex.try_emplace(
+        llvm::toStringRef(Sym), SymbolIndex.size());
+    return result.first->getValue();
+}
+
 bool
 BitcodeWriter::
 prepRecordData(
@@ -928,6 +1001,48 @@ emitBlock(
     emitRecord(T.Contents, TEMPLATE_PARAM_CONTENTS);
 }
 
+//------------------------------------------------
+
+TUBitcodeWriter::
+TUBitcodeWriter()
+    : stream_(bitcode_.data)
+    , writer_(std::make_unique<BitcodeWriter>(stream_))
+{
+}
+
+TUBitcodeWriter::
+~TUBitcodeWriter() = default;
+
+void
+TUBitcodeWriter::
+write(
+    Info const& I)
+{
+    // Top-level blocks begin and end on
+    // a word boundary, so the bit offsets
+    // are always whole numbers of bytes.
+    auto const offset = stream_.GetCurrentBitNo() / 8;
+    if(writer_->dispatchInfoForWrite(&I))
+        return;
+    auto const size = stream_.GetCurrentBitNo() / 8 - offset;
+    bitcode_.index.push_back({
+        I.USR,
+        static_cast<std::uint32_t>(offset),
+        static_cast<std::uint32_t>(size) });
+}
+
+TUData
+TUBitcodeWriter::
+release()
+{
+    // The tables are complete once every
+    // Info has been written, so they go last.
+    bitcode_.tablesOffset = static_cast<
+        std::uint32_t>(stream_.GetCurrentBitNo() / 8);
+    writer_->emitTableBlocks();
+    return std::move(bitcode_);
+}
+
 /** Write an Info variant to the bitstream.
 */
 void
@@ -937,6 +1052,7 @@ writeBitcode(
 {
     BitcodeWriter writer(Stream);
     writer.dispatchInfoForWrite(&I);
+    writer.emitTableBlocks();
 }
 
 } // mrdox
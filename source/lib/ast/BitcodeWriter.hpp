@@ -24,6 +24,7 @@
 #include <clang/AST/AST.h>
 #include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Bitstream/BitstreamWriter.h>
 #include <initializer_list>
@@ -45,6 +46,10 @@ public:
     void emitBlockInfoBlock();
     void emitVersionBlock();
 
+    // Emit the string and symbol tables. This
+    // must come after every Info in the stream.
+    void emitTableBlocks();
+
     // Block emission of different info types.
     void emitBlock(NamespaceInfo const& I);
     void emitBlock(RecordInfo const& I);
@@ -87,6 +92,10 @@ public:
 
     bool prepRecordData(RecordId ID, bool ShouldEmit = true);
 
+    // Return the index of a string or symbol in the tables.
+    unsigned getStringIndex(llvm::StringRef Str);
+    unsigned getSymbolIndex(SymbolID const& Sym);
+
     // Emission of appropriate abbreviation type.
     void emitAbbrev(RecordId ID, BlockId Block);
 
@@ -140,6 +149,11 @@ private:
         BitCodeConstants::RecordSize> Record;
     llvm::BitstreamWriter& Stream;
     AbbreviationMap Abbrevs;
+
+    // The keys of the string map own the strings.
+    llvm::StringMap<unsigned> StringIndex;
+    std::vector<llvm::StringRef> Strings;
+    llvm::StringMap<unsigned> SymbolIndex;
 };
 
 } // mrdox
@@ -0,0 +1,260 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "ast/CachingFileSystem.hpp"
+#include <llvm/ADT/Hashing.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/Path.h>
+#include <mutex>
+
+namespace clang {
+namespace mrdox {
+
+FileCache::
+FileCache(
+    llvm::IntrusiveRefCntPtr<
+        llvm::vfs::FileSystem> fs)
+    : fs_(std::move(fs))
+{
+}
+
+auto
+FileCache::
+shardFor(
+    llvm::StringRef absPath) noexcept ->
+        Shard&
+{
+    return shards_[llvm::hash_value(absPath) % shards_.size()];
+}
+
+llvm::ErrorOr<llvm::vfs::Status>
+FileCache::
+status(
+    llvm::StringRef absPath)
+{
+    Shard& shard = shardFor(absPath);
+    {
+        std::lock_guard<llvm::sys::Mutex> lock(shard.mutex);
+        auto it = shard.map.find(absPath);
+        if(it != shard.map.end() && it->second.hasStatus)
+            return it->second.status;
+    }
+
+    // Call the file system without holding the lock.
+    auto result = fs_->status(absPath);
+
+    std::lock_guard<llvm::sys::Mutex> lock(shard.mutex);
+    Entry& entry = shard.map[absPath];
+    if(! entry.hasStatus)
+    {
+        entry.status = result;
+        entry.hasStatus = true;
+    }
+    return entry.status;
+}
+
+llvm::ErrorOr<std::shared_ptr<llvm::MemoryBuffer const>>
+FileCache::
+getBuffer(
+    llvm::StringRef absPath)
+{
+    Shard& shard = shardFor(absPath);
+    {
+        std::lock_guard<llvm::sys::Mutex> lock(shard.mutex);
+        auto it = shard.map.find(absPath);
+        if(it != shard.map.end() && it->second.buffer)
+            return it->second.buffer;
+    }
+
+    // Two threads may read the same file at once,
+    // in which case the first buffer inserted wins.
+    auto result = fs_->getBufferForFile(absPath);
+    if(! result)
+        return result.getError();
+    std::shared_ptr<llvm::MemoryBuffer const> buffer(
+        std::move(*result));
+
+    std::lock_guard<llvm::sys::Mutex> lock(shard.mutex);
+    Entry& entry = shard.map[absPath];
+    if(! entry.buffer)
+        entry.buffer = std::move(buffer);
+    return entry.buffer;
+}
+
+//------------------------------------------------
+
+namespace {
+
+/*  A file whose contents are owned by the cache.
+*/
+class CachedFile : public llvm::vfs::File
+{
+    llvm::vfs::Status status_;
+    std::shared_ptr<llvm::MemoryBuffer const> buffer_;
+
+public:
+    CachedFile(
+        llvm::vfs::Status status,
+        std::shared_ptr<llvm::MemoryBuffer const> buffer) noexcept
+        : status_(std::move(status))
+        , buffer_(std::move(buffer))
+    {
+    }
+
+    llvm::ErrorOr<llvm::vfs::Status>
+    status() override
+    {
+        return status_;
+    }
+
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+    getBuffer(
+        llvm::Twine const& Name,
+        int64_t FileSize,
+        bool RequiresNullTerminator,
+        bool IsVolatile) override
+    {
+        // The cached buffer is always null terminated.
+        return llvm::MemoryBuffer::getMemBuffer(
+            buffer_->getMemBufferRef(),
+            RequiresNullTerminator);
+    }
+
+    std::error_code
+    close() override
+    {
+        return {};
+    }
+};
+
+/*  A view of the cache with its own working directory.
+*/
+class CachingFileSystem : public llvm::vfs::FileSystem
+{
+    std::shared_ptr<FileCache> cache_;
+    std::string cwd_;
+
+    void
+    makeAbsolutePath(
+        llvm::Twine const& Path,
+        llvm::SmallVectorImpl<char>& result) const
+    {
+        Path.toVector(result);
+        if(llvm::sys::path::is_absolute(result))
+            return;
+        llvm::SmallString<256> temp(cwd_);
+        llvm::sys::path::append(temp,
+            llvm::StringRef(result.data(), result.size()));
+        result.assign(temp.begin(), temp.end());
+    }
+
+public:
+    explicit
+    CachingFileSystem(
+        std::shared_ptr<FileCache> cache)
+        : cache_(std::move(cache))
+    {
+        auto cwd = cache_->fileSystem().getCurrentWorkingDirectory();
+        if(cwd)
+            cwd_ = std::move(*cwd);
+    }
+
+    llvm::ErrorOr<llvm::vfs::Status>
+    status(
+        llvm::Twine const& Path) override
+    {
+        llvm::SmallString<256> absPath;
+        makeAbsolutePath(Path, absPath);
+        auto result = cache_->status(absPath);
+        if(! result)
+            return result;
+        return llvm::vfs::Status::copyWithNewName(*result, Path);
+    }
+
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+    openFileForRead(
+        llvm::Twine const& Path) override
+    {
+        llvm::SmallString<256> absPath;
+        makeAbsolutePath(Path, absPath);
+        auto st = cache_->status(absPath);
+        if(! st)
+            return st.getError();
+        if(st->isDirectory())
+            return std::make_error_code(std::errc::is_a_directory);
+        auto buffer = cache_->getBuffer(absPath);
+        if(! buffer)
+            return buffer.getError();
+        return std::make_unique<CachedFile>(
+            llvm::vfs::Status::copyWithNewName(*st, Path),
+            std::move(*buffer));
+    }
+
+    llvm::vfs::directory_iterator
+    dir_begin(
+        llvm::Twine const& Dir,
+        std::error_code& EC) override
+    {
+        // Directory listings are rare, and not cached.
+        llvm::SmallString<256> absPath;
+        makeAbsolutePath(Dir, absPath);
+        return cache_->fileSystem().dir_begin(absPath, EC);
+    }
+
+    llvm::ErrorOr<std::string>
+    getCurrentWorkingDirectory() const override
+    {
+        return cwd_;
+    }
+
+    std::error_code
+    setCurrentWorkingDirectory(
+        llvm::Twine const& Path) override
+    {
+        llvm::SmallString<256> absPath;
+        makeAbsolutePath(Path, absPath);
+        llvm::sys::path::remove_dots(absPath, true);
+        cwd_ = absPath.str();
+        return {};
+    }
+
+    std::error_code
+    getRealPath(
+        llvm::Twine const& Path,
+        llvm::SmallVectorImpl<char>& Output) const override
+    {
+        llvm::SmallString<256> absPath;
+        makeAbsolutePath(Path, absPath);
+        return cache_->fileSystem().getRealPath(absPath, Output);
+    }
+
+    std::error_code
+    isLocal(
+        llvm::Twine const& Path,
+        bool& Result) override
+    {
+        llvm::SmallString<256> absPath;
+        makeAbsolutePath(Path, absPath);
+        return cache_->fileSystem().isLocal(absPath, Result);
+    }
+};
+
+} // (anon)
+
+llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>
+makeCachingFileSystem(
+    std::shared_ptr<FileCache> cache)
+{
+    return llvm::makeIntrusiveRefCnt<
+        CachingFileSystem>(std::move(cache));
+}
+
+} // mrdox
+} // clang
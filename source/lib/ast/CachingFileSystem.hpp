@@ -0,0 +1,117 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_AST_CACHINGFILESYSTEM_HPP
+#define MRDOX_SOURCE_AST_CACHINGFILESYSTEM_HPP
+
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Mutex.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <array>
+#include <memory>
+
+namespace clang {
+namespace mrdox {
+
+/** A process-wide cache of file system queries.
+
+    The cache memoizes the results of stat calls,
+    including failures, and keeps the contents of
+    files which were opened in immutable buffers
+    shared by every reader. Files are assumed not
+    to change while the cache is alive.
+
+    Entries are keyed by absolute path. Use
+    @ref makeCachingFileSystem to obtain a file
+    system which resolves relative paths against
+    its own working directory.
+
+    @par Thread Safety
+    May be called concurrently.
+*/
+class FileCache
+{
+public:
+    /** Constructor.
+
+        @param fs The underlying file system.
+        It must be safe to call concurrently
+        when all paths are absolute.
+    */
+    explicit
+    FileCache(
+        llvm::IntrusiveRefCntPtr<
+            llvm::vfs::FileSystem> fs =
+                llvm::vfs::createPhysicalFileSystem());
+
+    /** Return the status of a file.
+
+        @param absPath The absolute path to the file.
+    */
+    llvm::ErrorOr<llvm::vfs::Status>
+    status(
+        llvm::StringRef absPath);
+
+    /** Return the contents of a file.
+
+        The returned buffer is null terminated.
+
+        @param absPath The absolute path to the file.
+    */
+    llvm::ErrorOr<std::shared_ptr<llvm::MemoryBuffer const>>
+    getBuffer(
+        llvm::StringRef absPath);
+
+    /** Return the underlying file system.
+    */
+    llvm::vfs::FileSystem&
+    fileSystem() const noexcept
+    {
+        return *fs_;
+    }
+
+private:
+    struct Entry
+    {
+        llvm::ErrorOr<llvm::vfs::Status> status =
+            std::error_code();
+        std::shared_ptr<llvm::MemoryBuffer const> buffer;
+        bool hasStatus = false;
+    };
+
+    struct Shard
+    {
+        llvm::sys::Mutex mutex;
+        llvm::StringMap<Entry> map;
+    };
+
+    Shard& shardFor(llvm::StringRef absPath) noexcept;
+
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> fs_;
+    std::array<Shard, 32> shards_;
+};
+
+/** Return a file system which reads through a shared cache.
+
+    Each returned file system has its own working
+    directory, so that tools running concurrently
+    can change directories independently while
+    sharing the cache.
+*/
+llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>
+makeCachingFileSystem(
+    std::shared_ptr<FileCache> cache);
+
+} // mrdox
+} // clang
+
+#endif
@@ -0,0 +1,114 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "ast/Codec.hpp"
+#include "ast/Bitcode.hpp"
+#include <mrdox/Error.hpp>
+#include <mrdox/Metadata.hpp>
+
+namespace clang {
+namespace mrdox {
+
+namespace {
+
+class BitcodeDecoder : public InfoDecoder
+{
+    TUData const& tu_;
+    Reporter& R_;
+    BitcodeTables tables_;
+
+public:
+    BitcodeDecoder(
+        TUData const& tu,
+        Reporter& R) noexcept
+        : tu_(tu)
+        , R_(R)
+    {
+    }
+
+    llvm::Error
+    init()
+    {
+        return readBitcodeTables(tu_, tables_, R_);
+    }
+
+    llvm::Expected<DecodedInfo>
+    read(
+        TUData::Slice const& slice,
+        InfoArena* arena) override
+    {
+        return readBitcode(tu_.slice(slice), tables_, arena, R_);
+    }
+};
+
+class BitcodeCodec : public Codec
+{
+public:
+    llvm::StringRef
+    name() const noexcept override
+    {
+        return "bitcode";
+    }
+
+    std::unique_ptr<InfoEncoder>
+    makeEncoder() const override
+    {
+        return std::make_unique<TUBitcodeWriter>();
+    }
+
+    llvm::Expected<std::unique_ptr<InfoDecoder>>
+    makeDecoder(
+        TUData const& tu,
+        Reporter& R) const override
+    {
+        // The BlockInfo and tables are read once per
+        // translation unit and shared by the readers
+        // of its blocks.
+        auto decoder = std::make_unique<BitcodeDecoder>(tu, R);
+        if(auto err = decoder->init())
+            return err;
+        return decoder;
+    }
+};
+
+} // (anon)
+
+//------------------------------------------------
+
+void
+InfoDeleter::
+operator()(Info* I) const noexcept
+{
+    if(inArena)
+        I->~Info();
+    else
+        delete I;
+}
+
+std::unique_ptr<Codec>
+makeBitcodeCodec()
+{
+    return std::make_unique<BitcodeCodec>();
+}
+
+llvm::Expected<std::unique_ptr<Codec>>
+makeCodec(
+    Config const& config)
+{
+    llvm::StringRef format = config.intermediateFormat();
+    if(format == "bitcode")
+        return makeBitcodeCodec();
+    if(format == "flat")
+        return makeFlatCodec();
+    return makeError("unknown intermediate format '", format, "'");
+}
+
+} // mrdox
+} // clang
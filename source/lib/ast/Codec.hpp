@@ -0,0 +1,272 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_AST_CODEC_HPP
+#define MRDOX_SOURCE_AST_CODEC_HPP
+
+#include <mrdox/Config.hpp>
+#include <mrdox/MetadataFwd.hpp>
+#include <mrdox/Reporter.hpp>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Allocator.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/Mutex.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace clang {
+namespace mrdox {
+
+/** The encoded Info for one translation unit.
+
+    The layout of the bytes is up to the codec
+    which produced them. Every codec writes each
+    Info to its own contiguous slice, followed
+    by whatever tables the slices refer to.
+*/
+struct TUData
+{
+    /** The location of one Info in the data.
+    */
+    struct Slice
+    {
+        SymbolID id;
+        std::uint32_t offset; // in bytes
+        std::uint32_t size;   // in bytes
+    };
+
+    llvm::SmallVector<char, 0> data;
+    std::vector<Slice> index;
+    std::uint32_t tablesOffset = 0;
+
+    /** Return the bytes of one Info.
+    */
+    llvm::StringRef
+    slice(Slice const& s) const noexcept
+    {
+        return llvm::StringRef(data.data() + s.offset, s.size);
+    }
+};
+
+/** A thread-safe store for the data of each translation unit.
+*/
+class TUResults
+{
+public:
+    /** Add the data for one translation unit.
+    */
+    void
+    add(TUData&& data)
+    {
+        std::lock_guard<llvm::sys::Mutex> lock(mutex_);
+        results_.emplace_back(std::move(data));
+    }
+
+    /** Remove and return the results added so far.
+    */
+    std::vector<TUData>
+    take()
+    {
+        std::lock_guard<llvm::sys::Mutex> lock(mutex_);
+        return std::exchange(results_, {});
+    }
+
+    /** Return the results.
+
+        This may only be called once every
+        translation unit has been visited.
+    */
+    std::vector<TUData>&
+    results() noexcept
+    {
+        return results_;
+    }
+
+private:
+    llvm::sys::Mutex mutex_;
+    std::vector<TUData> results_;
+};
+
+//------------------------------------------------
+
+/** Encodes the Info from one translation unit.
+*/
+class InfoEncoder
+{
+public:
+    virtual ~InfoEncoder() = default;
+
+    /** Append an Info to the data.
+    */
+    virtual
+    void
+    write(Info const& I) = 0;
+
+    /** Finish the data and return it.
+
+        No more Info may be written afterwards.
+    */
+    virtual
+    TUData
+    release() = 0;
+};
+
+/** Memory for Info which is decoded only to be merged.
+
+    Every symbol seen in more than one translation
+    unit is decoded several times and merged, after
+    which the decoded copies are discarded. Building
+    them in an arena which is reset after each
+    merge avoids allocating each one on the heap.
+
+    The strings and lists owned by the Info are
+    still allocated normally.
+*/
+class InfoArena
+{
+public:
+    /** Return a new T constructed in the arena.
+    */
+    template<class T>
+    T*
+    make()
+    {
+        return new(alloc_.Allocate(
+            sizeof(T), alignof(T))) T();
+    }
+
+    /** Release the memory of every Info made so far.
+
+        Each of them must have been destroyed.
+    */
+    void
+    reset() noexcept
+    {
+        alloc_.Reset();
+    }
+
+private:
+    llvm::BumpPtrAllocator alloc_;
+};
+
+/** Destroys an Info returned by a decoder.
+
+    An Info made in an arena is only destroyed,
+    because its memory belongs to the arena.
+*/
+struct InfoDeleter
+{
+    bool inArena = false;
+
+    void
+    operator()(Info* I) const noexcept;
+};
+
+/** An Info returned by a decoder.
+*/
+using DecodedInfo = std::unique_ptr<Info, InfoDeleter>;
+
+/** Return a new T for a decoder to fill in.
+
+    @param arena The arena to make it in,
+    or null to allocate it on the heap.
+*/
+template<class T>
+DecodedInfo
+makeDecodedInfo(
+    InfoArena* arena)
+{
+    if(! arena)
+        return DecodedInfo(new T());
+    return DecodedInfo(arena->make<T>(), InfoDeleter{true});
+}
+
+/** Decodes the Info from one translation unit.
+
+    @par Thread Safety
+    May be called concurrently.
+*/
+class InfoDecoder
+{
+public:
+    virtual ~InfoDecoder() = default;
+
+    /** Return the Info in one slice.
+
+        @param arena The arena to make the Info
+        in, or null to allocate it on the heap.
+    */
+    virtual
+    llvm::Expected<DecodedInfo>
+    read(
+        TUData::Slice const& slice,
+        InfoArena* arena = nullptr) = 0;
+};
+
+/** An intermediate format for the Info.
+
+    The mapping phase encodes the Info of each
+    translation unit, and the reducing phase
+    decodes every slice which has the same
+    symbol ID before merging them.
+*/
+class Codec
+{
+public:
+    virtual ~Codec() = default;
+
+    /** Return the name used to select the codec.
+    */
+    virtual
+    llvm::StringRef
+    name() const noexcept = 0;
+
+    /** Return a new encoder for one translation unit.
+    */
+    virtual
+    std::unique_ptr<InfoEncoder>
+    makeEncoder() const = 0;
+
+    /** Return a decoder for one translation unit.
+
+        @param tu The data to read, which must
+        outlive the decoder.
+    */
+    virtual
+    llvm::Expected<std::unique_ptr<InfoDecoder>>
+    makeDecoder(
+        TUData const& tu,
+        Reporter& R) const = 0;
+};
+
+/** Return the codec which reads and writes LLVM bitcode.
+*/
+std::unique_ptr<Codec>
+makeBitcodeCodec();
+
+/** Return the codec which reads and writes the flat format.
+*/
+std::unique_ptr<Codec>
+makeFlatCodec();
+
+/** Return the codec selected by the configuration.
+*/
+llvm::Expected<std::unique_ptr<Codec>>
+makeCodec(
+    Config const& config);
+
+} // mrdox
+} // clang
+
+#endif
@@ -0,0 +1,279 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "ast/Executor.hpp"
+#include "ast/ProcessPool.hpp"
+#include <mrdox/Error.hpp>
+#include <clang/Tooling/AllTUsExecution.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/Mutex.h>
+#include <llvm/Support/Regex.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+
+namespace clang {
+namespace mrdox {
+
+namespace {
+
+class ThreadSafeToolResults : public tooling::ToolResults
+{
+    tooling::InMemoryToolResults results_;
+    llvm::sys::Mutex mutex_;
+
+public:
+    void
+    addResult(
+        llvm::StringRef Key,
+        llvm::StringRef Value) override
+    {
+        std::lock_guard<llvm::sys::Mutex> lock(mutex_);
+        results_.addResult(Key, Value);
+    }
+
+    std::vector<std::pair<llvm::StringRef, llvm::StringRef>>
+    AllKVResults() override
+    {
+        return results_.AllKVResults();
+    }
+
+    void
+    forEachResult(
+        llvm::function_ref<void(
+            llvm::StringRef Key,
+            llvm::StringRef Value)> Callback) override
+    {
+        results_.forEachResult(Callback);
+    }
+};
+
+} // (anon)
+
+//------------------------------------------------
+
+char const* Executor::ExecutorName = "MrDoxExecutor";
+
+Executor::
+Executor(
+    tooling::CompilationDatabase const& db,
+    Scheduler& scheduler,
+    MemoryBudget& budget,
+    TUStats& stats,
+    TUResults& tuResults,
+    Config const& config,
+    Reporter& R)
+    : db_(db)
+    , scheduler_(scheduler)
+    , budget_(budget)
+    , stats_(stats)
+    , tuResults_(tuResults)
+    , config_(config)
+    , R_(R)
+    , cache_(std::make_shared<FileCache>())
+    , results_(std::make_unique<ThreadSafeToolResults>())
+    , context_(results_.get())
+{
+}
+
+Executor::
+~Executor() = default;
+
+llvm::Error
+Executor::
+execute(
+    llvm::ArrayRef<std::pair<
+        std::unique_ptr<tooling::FrontendActionFactory>,
+        tooling::ArgumentsAdjuster>> Actions)
+{
+    if(Actions.empty())
+        return makeError("no action specified");
+    if(Actions.size() != 1)
+        return makeError("only one action is supported");
+    auto& Action = Actions.front();
+
+    // The files are filtered by the --filter
+    // option, as AllTUsToolExecutor does.
+    std::vector<std::string> files;
+    llvm::Regex RegexFilter(tooling::Filter);
+    for(auto& file : db_.getAllFiles())
+        if(RegexFilter.match(file))
+            files.push_back(std::move(file));
+
+    // Start the slowest translation units first,
+    // so that none of them is left for the end.
+    std::size_t const recorded = stats_.order(files);
+    std::string const totalStr = std::to_string(files.size());
+    std::atomic<std::size_t> counter = 0;
+
+    // The tail is the time from when the first
+    // worker runs out of translation units until
+    // the last one is done.
+    using clock = std::chrono::steady_clock;
+    auto const start = clock::now();
+    std::atomic<std::size_t> started = 0;
+    std::atomic<clock::rep> tailStart = 0;
+
+    llvm::sys::Mutex errorMutex;
+    std::string errorMsg;
+
+    // Run the action on one translation unit.
+    auto runTool = [&](std::string const& path)
+    {
+        // Each tool gets its own view of the cache,
+        // since tools change the working directory.
+        tooling::ClangTool Tool(db_, { path },
+            std::make_shared<PCHContainerOperations>(),
+            makeCachingFileSystem(cache_));
+        Tool.appendArgumentsAdjuster(Action.second);
+        Tool.appendArgumentsAdjuster(
+            tooling::getDefaultArgumentsAdjusters());
+        for(auto const& overlay : overlayFiles_)
+            Tool.mapVirtualFile(overlay.getKey(), overlay.getValue());
+        return Tool.run(Action.first.get()) == 0;
+    };
+
+    auto finish = [&](
+        std::string const& path,
+        clock::time_point tuStart)
+    {
+        auto const tuEnd = clock::now();
+        stats_.record(path,
+            std::chrono::duration<double>(tuEnd - tuStart).count());
+        clock::rep none = 0;
+        if(started == files.size())
+            tailStart.compare_exchange_strong(none,
+                (tuEnd - start).count());
+    };
+
+    bool isolate = config_.isolateMap();
+    if(isolate && ! ProcessPool::isSupported())
+    {
+        R_.print("warning: worker processes are not supported on this platform");
+        isolate = false;
+    }
+
+    if(! isolate)
+    {
+        scheduler_.forEach(Phase::map, files.size(),
+            [&](std::size_t i)
+            {
+                std::string const& path = files[i];
+                std::uint64_t const reserved = budget_.admit(path);
+                ++started;
+                auto const tuStart = clock::now();
+                if(config_.verbose())
+                    R_.print("[", ++counter, "/", totalStr,
+                        "] Processing file ", path);
+                if(! runTool(path))
+                {
+                    std::lock_guard<llvm::sys::Mutex> lock(errorMutex);
+                    errorMsg += "Failed to run action on " + path + "\n";
+                }
+                budget_.release(reserved);
+                finish(path, tuStart);
+            });
+    }
+    else
+    {
+        // Each worker thread owns one child process.
+        // The children do not use the statistics or
+        // the error message, and only measure memory
+        // for the parent to record, so only the
+        // reporter needs the fork mutex here.
+        std::size_t const workers = std::min<std::size_t>(
+            files.size(), scheduler_.concurrency(Phase::map));
+        ProcessPool pool(workers, tuResults_,
+            [&](std::size_t i)
+            {
+                ProcessPool::Outcome outcome;
+                outcome.ok = runTool(files[i]);
+                auto const m = budget_.takeMeasurement();
+                outcome.fileSize = m.fileSize;
+                outcome.memory = m.bytes;
+                return outcome;
+            },
+            [&]
+            {
+                budget_.detach();
+            },
+            std::chrono::seconds(config_.mapTimeout()));
+        std::atomic<std::size_t> next = 0;
+        scheduler_.run(Phase::map, workers,
+            [&](std::size_t w)
+            {
+                for(;;)
+                {
+                    std::size_t const i = next++;
+                    if(i >= files.size())
+                        return;
+                    std::string const& path = files[i];
+                    std::uint64_t const reserved = budget_.admit(path);
+                    ++started;
+                    auto const tuStart = clock::now();
+                    if(config_.verbose())
+                    {
+                        std::shared_lock<std::shared_mutex> lock(pool.forkMutex());
+                        R_.print("[", ++counter, "/", totalStr,
+                            "] Processing file ", path);
+                    }
+                    for(unsigned attempt = 0;; ++attempt)
+                    {
+                        auto ok = pool.run(w, i);
+                        if(ok)
+                        {
+                            if(ok->memory != 0)
+                                budget_.record(path, ok->fileSize, ok->memory);
+                            if(! ok->ok)
+                            {
+                                std::lock_guard<llvm::sys::Mutex> lock(errorMutex);
+                                errorMsg += "Failed to run action on " + path + "\n";
+                            }
+                            break;
+                        }
+                        std::string const msg = toString(ok.takeError());
+                        std::shared_lock<std::shared_mutex> lock(pool.forkMutex());
+                        if(attempt < config_.mapRetries())
+                        {
+                            R_.print("warning: ", msg, " mapping ", path, ", retrying");
+                            continue;
+                        }
+                        R_.print("warning: ", msg, " mapping ", path, ", skipping it");
+                        std::lock_guard<llvm::sys::Mutex> errorLock(errorMutex);
+                        errorMsg += "Skipped " + path + " because " + msg + "\n";
+                        break;
+                    }
+                    budget_.release(reserved);
+                    finish(path, tuStart);
+                }
+            });
+    }
+
+    if(config_.verbose() && ! files.empty())
+    {
+        auto const elapsed = clock::now() - start;
+        std::chrono::duration<double> const total = elapsed;
+        std::chrono::duration<double> const tail =
+            elapsed - clock::duration(tailStart.load());
+        R_.print("Mapped ", files.size(), " translation units in ",
+            llvm::format("%.3f", total.count()), "s (tail ",
+            llvm::format("%.3f", tail.count()), "s, ",
+            recorded, " ordered by recorded time)");
+    }
+
+    if(! errorMsg.empty())
+        return makeErrorString(std::move(errorMsg));
+    return llvm::Error::success();
+}
+
+} // mrdox
+} // clang
@@ -0,0 +1,126 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_AST_EXECUTOR_HPP
+#define MRDOX_SOURCE_AST_EXECUTOR_HPP
+
+#include "ast/CachingFileSystem.hpp"
+#include "ast/Codec.hpp"
+#include "ast/MemoryBudget.hpp"
+#include "ast/TUStats.hpp"
+#include "Scheduler.hpp"
+#include <mrdox/Config.hpp>
+#include <mrdox/Reporter.hpp>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Execution.h>
+#include <llvm/ADT/StringMap.h>
+#include <memory>
+
+namespace clang {
+namespace mrdox {
+
+/** Executes a frontend action on every translation unit.
+
+    This works like `tooling::AllTUsToolExecutor`,
+    except that all of the tool invocations read
+    the file system through one shared @ref FileCache.
+    Each header is thus stat'd and read from disk
+    once per run instead of once per translation unit.
+    Like it, only the files which match the `--filter`
+    option are run.
+*/
+class Executor : public tooling::ToolExecutor
+{
+public:
+    static char const* ExecutorName;
+
+    /** Constructor.
+
+        @param db The compilation database, whose
+        lifetime must extend until the executor
+        is destroyed.
+
+        @param scheduler The scheduler which runs
+        the tool invocations, in the map phase.
+
+        @param budget The budget which admits each
+        translation unit before it is parsed.
+
+        @param stats The statistics which order the
+        translation units, and receive their times.
+
+        @param tuResults The results which the action
+        adds to. When translation units are mapped in
+        worker processes, the data they send back is
+        added here.
+    */
+    Executor(
+        tooling::CompilationDatabase const& db,
+        Scheduler& scheduler,
+        MemoryBudget& budget,
+        TUStats& stats,
+        TUResults& tuResults,
+        Config const& config,
+        Reporter& R);
+
+    ~Executor();
+
+    llvm::StringRef
+    getExecutorName() const override
+    {
+        return ExecutorName;
+    }
+
+    using ToolExecutor::execute;
+
+    llvm::Error
+    execute(
+        llvm::ArrayRef<std::pair<
+            std::unique_ptr<tooling::FrontendActionFactory>,
+            tooling::ArgumentsAdjuster>> Actions) override;
+
+    tooling::ExecutionContext*
+    getExecutionContext() override
+    {
+        return &context_;
+    }
+
+    tooling::ToolResults*
+    getToolResults() override
+    {
+        return results_.get();
+    }
+
+    void
+    mapVirtualFile(
+        llvm::StringRef FilePath,
+        llvm::StringRef Content) override
+    {
+        overlayFiles_[FilePath] = std::string(Content);
+    }
+
+private:
+    tooling::CompilationDatabase const& db_;
+    Scheduler& scheduler_;
+    MemoryBudget& budget_;
+    TUStats& stats_;
+    TUResults& tuResults_;
+    Config const& config_;
+    Reporter& R_;
+    std::shared_ptr<FileCache> cache_;
+    std::unique_ptr<tooling::ToolResults> results_;
+    tooling::ExecutionContext context_;
+    llvm::StringMap<std::string> overlayFiles_;
+};
+
+} // mrdox
+} // clang
+
+#endif
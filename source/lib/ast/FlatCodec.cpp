@@ -0,0 +1,954 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "ast/Codec.hpp"
+#include <mrdox/Error.hpp>
+#include <mrdox/Metadata.hpp>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/Endian.h>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+
+namespace clang {
+namespace mrdox {
+
+/*  The flat format
+
+    Every field is a whole number of bytes, stored
+    little-endian with no alignment requirement:
+
+        u8      enums, bools, and the kind of a node
+        u32     integers, list sizes, and indexes
+
+    Strings and symbol IDs are stored once per
+    translation unit, in tables which follow the
+    last Info. A field refers to them by index.
+    Each table is read in place: looking up an
+    entry is a bounds check and an offset.
+
+    data:
+        "MRDF" u32(version)
+        Info...
+        u32(nstr) u32(offset)[nstr + 1] char[]
+        u32(nsym) u8[20][nsym]
+
+    Each Info begins with its InfoType, followed
+    by the same fields as the bitcode, in the
+    same order. Optional fields are preceded by
+    a u8 which is zero when the field is absent.
+*/
+
+namespace {
+
+constexpr char Magic[4] = { 'M', 'R', 'D', 'F' };
+constexpr std::uint32_t FlatVersion = 1;
+constexpr std::size_t PrologueSize = 8;
+
+//------------------------------------------------
+
+class FlatWriter : public InfoEncoder
+{
+    TUData data_;
+    llvm::StringMap<std::uint32_t> stringIndex_;
+    std::vector<llvm::StringRef> strings_;
+    llvm::StringMap<std::uint32_t> symbolIndex_;
+    std::vector<SymbolID> symbols_;
+
+public:
+    FlatWriter()
+    {
+        data_.data.append(std::begin(Magic), std::end(Magic));
+        put32(FlatVersion);
+    }
+
+    void
+    write(Info const& I) override
+    {
+        auto const offset = data_.data.size();
+        switch(I.IT)
+        {
+        case InfoType::IT_namespace:
+            put8(static_cast<unsigned>(I.IT));
+            put(static_cast<NamespaceInfo const&>(I));
+            break;
+        case InfoType::IT_record:
+            put8(static_cast<unsigned>(I.IT));
+            put(static_cast<RecordInfo const&>(I));
+            break;
+        case InfoType::IT_function:
+            put8(static_cast<unsigned>(I.IT));
+            put(static_cast<FunctionInfo const&>(I));
+            break;
+        case InfoType::IT_enum:
+            put8(static_cast<unsigned>(I.IT));
+            put(static_cast<EnumInfo const&>(I));
+            break;
+        case InfoType::IT_typedef:
+            put8(static_cast<unsigned>(I.IT));
+            put(static_cast<TypedefInfo const&>(I));
+            break;
+        default:
+            return;
+        }
+        data_.index.push_back({
+            I.USR,
+            static_cast<std::uint32_t>(offset),
+            static_cast<std::uint32_t>(data_.data.size() - offset) });
+    }
+
+    TUData
+    release() override
+    {
+        data_.tablesOffset = static_cast<
+            std::uint32_t>(data_.data.size());
+
+        put32(strings_.size());
+        std::uint32_t offset = 0;
+        put32(offset);
+        for(auto const& s : strings_)
+        {
+            offset += s.size();
+            put32(offset);
+        }
+        for(auto const& s : strings_)
+            data_.data.append(s.begin(), s.end());
+
+        put32(symbols_.size());
+        for(auto const& id : symbols_)
+            data_.data.append(id.begin(), id.end());
+        return std::move(data_);
+    }
+
+private:
+    void
+    put8(unsigned v)
+    {
+        assert(v <= 0xff);
+        data_.data.push_back(static_cast<char>(v));
+    }
+
+    void
+    put32(std::uint64_t v)
+    {
+        assert(v <= 0xffffffff);
+        char buf[4];
+        llvm::support::endian::write32le(buf,
+            static_cast<std::uint32_t>(v));
+        data_.data.append(buf, buf + 4);
+    }
+
+    void
+    put(bool v)
+    {
+        put8(v ? 1 : 0);
+    }
+
+    void
+    put(llvm::StringRef s)
+    {
+        auto result = stringIndex_.try_emplace(s, strings_.size());
+        if(result.second)
+            strings_.push_back(result.first->getKey());
+        put32(result.first->getValue());
+    }
+
+    void
+    put(SymbolID const& id)
+    {
+        auto result = symbolIndex_.try_emplace(
+            llvm::toStringRef(id), symbols_.size());
+        if(result.second)
+            symbols_.push_back(id);
+        put32(result.first->getValue());
+    }
+
+    template<class Enum>
+    void
+    putEnum(Enum v)
+    {
+        put8(static_cast<unsigned>(v));
+    }
+
+    template<class Range, class F>
+    void
+    putList(Range const& list, F const& f)
+    {
+        put32(list.size());
+        for(auto const& v : list)
+            f(v);
+    }
+
+    //--------------------------------------------
+
+    void
+    put(Location const& L)
+    {
+        put32(static_cast<std::uint32_t>(L.LineNumber));
+        put(L.IsFileInRootDir);
+        put(llvm::StringRef(L.Filename));
+    }
+
+    void
+    put(Reference const& R)
+    {
+        put(R.USR);
+        put(llvm::StringRef(R.Name));
+        putEnum(R.RefType);
+        put(llvm::StringRef(R.Path));
+    }
+
+    void
+    put(FieldTypeInfo const& F)
+    {
+        put(F.Type);
+        put(llvm::StringRef(F.Name));
+        put(llvm::StringRef(F.DefaultValue));
+    }
+
+    void
+    put(MemberTypeInfo const& M)
+    {
+        put(M.Type);
+        put(llvm::StringRef(M.Name));
+        putEnum(M.Access);
+        put(M.javadoc);
+    }
+
+    void
+    put(TemplateParamInfo const& P)
+    {
+        put(llvm::StringRef(P.Contents));
+    }
+
+    void
+    put(llvm::Optional<TemplateInfo> const& T)
+    {
+        put(T.has_value());
+        if(! T)
+            return;
+        putList(T->Params, [&](auto const& P) { put(P); });
+        put(T->Specialization.has_value());
+        if(! T->Specialization)
+            return;
+        put(T->Specialization->SpecializationOf);
+        putList(T->Specialization->Params,
+            [&](auto const& P) { put(P); });
+    }
+
+    void
+    put(Scope const& S)
+    {
+        putList(S.Namespaces, [&](auto const& R) { put(R); });
+        putList(S.Records, [&](auto const& R) { put(R); });
+        putList(S.Functions, [&](auto const& R) { put(R); });
+        putList(S.Enums, [&](auto const& I) { put(I); });
+        putList(S.Typedefs, [&](auto const& I) { put(I); });
+    }
+
+    //--------------------------------------------
+
+    void
+    put(Javadoc::Node const& node)
+    {
+        putEnum(node.kind);
+        switch(node.kind)
+        {
+        case Javadoc::Kind::text:
+        {
+            auto const& J = static_cast<Javadoc::Text const&>(node);
+            put(llvm::StringRef(J.string));
+            break;
+        }
+        case Javadoc::Kind::styled:
+        {
+            auto const& J = static_cast<Javadoc::StyledText const&>(node);
+            putEnum(J.style);
+            put(llvm::StringRef(J.string));
+            break;
+        }
+        case Javadoc::Kind::paragraph:
+        case Javadoc::Kind::brief:
+        case Javadoc::Kind::code:
+        case Javadoc::Kind::returns:
+        {
+            auto const& J = static_cast<Javadoc::Paragraph const&>(node);
+            putNodes(J.children);
+            break;
+        }
+        case Javadoc::Kind::admonition:
+        {
+            auto const& J = static_cast<Javadoc::Admonition const&>(node);
+            putEnum(J.style);
+            putNodes(J.children);
+            break;
+        }
+        case Javadoc::Kind::param:
+        {
+            auto const& J = static_cast<Javadoc::Param const&>(node);
+            put(llvm::StringRef(J.name));
+            putNodes(J.children);
+            break;
+        }
+        case Javadoc::Kind::tparam:
+        {
+            auto const& J = static_cast<Javadoc::TParam const&>(node);
+            put(llvm::StringRef(J.name));
+            putNodes(J.children);
+            break;
+        }
+        default:
+            llvm_unreachable("unknown kind");
+        }
+    }
+
+    template<class T>
+    void
+    putNodes(List<T> const& list)
+    {
+        put32(list.size());
+        for(Javadoc::Node const& node : list)
+            put(node);
+    }
+
+    void
+    put(Javadoc const& jd)
+    {
+        putNodes(jd.getBlocks());
+        putNodes(jd.getParams());
+        putNodes(jd.getTParams());
+        putNodes(jd.getReturns().children);
+    }
+
+    //--------------------------------------------
+
+    void
+    putInfoPart(Info const& I)
+    {
+        put(I.USR);
+        put(llvm::StringRef(I.Name));
+        put(llvm::StringRef(I.Path));
+        putList(I.Namespace, [&](auto const& R) { put(R); });
+        put(I.javadoc);
+    }
+
+    void
+    putSymbolPart(SymbolInfo const& I)
+    {
+        putInfoPart(I);
+        put(I.DefLoc.has_value());
+        if(I.DefLoc)
+            put(*I.DefLoc);
+        putList(I.Loc, [&](auto const& L) { put(L); });
+    }
+
+    void
+    put(NamespaceInfo const& I)
+    {
+        putInfoPart(I);
+        put(I.Children);
+    }
+
+    void
+    put(BaseRecordInfo const& I)
+    {
+        put(I.USR);
+        put(llvm::StringRef(I.Name));
+        put(llvm::StringRef(I.Path));
+        putEnum(I.TagType);
+        put(I.IsVirtual);
+        putEnum(I.Access);
+        put(I.IsParent);
+        putList(I.Members, [&](auto const& M) { put(M); });
+    }
+
+    void
+    put(RecordInfo const& I)
+    {
+        putSymbolPart(I);
+        putEnum(I.TagType);
+        put(I.IsTypeDef);
+        putList(I.Members, [&](auto const& M) { put(M); });
+        putList(I.Parents, [&](auto const& R) { put(R); });
+        putList(I.VirtualParents, [&](auto const& R) { put(R); });
+        putList(I.Bases, [&](auto const& B) { put(B); });
+        put(I.Children);
+        put(I.Template);
+    }
+
+    void
+    put(FunctionInfo const& I)
+    {
+        putSymbolPart(I);
+        putEnum(I.Access);
+        put(I.IsMethod);
+        put(I.Parent);
+        put(I.ReturnType.Type);
+        putList(I.Params, [&](auto const& P) { put(P); });
+        put(I.Template);
+    }
+
+    void
+    put(EnumInfo const& I)
+    {
+        putSymbolPart(I);
+        put(I.Scoped);
+        put(I.BaseType.has_value());
+        if(I.BaseType)
+            put(I.BaseType->Type);
+        putList(I.Members, [&](auto const& V)
+        {
+            put(llvm::StringRef(V.Name));
+            put(llvm::StringRef(V.Value));
+            put(llvm::StringRef(V.ValueExpr));
+        });
+    }
+
+    void
+    put(TypedefInfo const& I)
+    {
+        putSymbolPart(I);
+        put(I.IsUsing);
+        put(I.Underlying.Type);
+    }
+};
+
+//------------------------------------------------
+
+/*  The tables of one translation unit, read in place.
+*/
+struct FlatTables
+{
+    char const* offsets = nullptr;
+    char const* chars = nullptr;
+    char const* symbols = nullptr;
+    std::uint32_t stringCount = 0;
+    std::uint32_t charCount = 0;
+    std::uint32_t symbolCount = 0;
+};
+
+/*  Reads one Info from a slice.
+
+    Errors are sticky: once the input is found
+    to be malformed every read returns a default
+    value, and the result is checked at the end.
+*/
+class FlatReader
+{
+    FlatTables const& tables_;
+    InfoArena* arena_;
+    char const* p_;
+    char const* end_;
+    bool failed_ = false;
+
+public:
+    FlatReader(
+        FlatTables const& tables,
+        InfoArena* arena,
+        llvm::StringRef bytes) noexcept
+        : tables_(tables)
+        , arena_(arena)
+        , p_(bytes.begin())
+        , end_(bytes.end())
+    {
+    }
+
+    llvm::Expected<DecodedInfo>
+    readInfo()
+    {
+        switch(static_cast<InfoType>(get8()))
+        {
+        case InfoType::IT_namespace:
+            return finish<NamespaceInfo>();
+        case InfoType::IT_record:
+            return finish<RecordInfo>();
+        case InfoType::IT_function:
+            return finish<FunctionInfo>();
+        case InfoType::IT_enum:
+            return finish<EnumInfo>();
+        case InfoType::IT_typedef:
+            return finish<TypedefInfo>();
+        default:
+            return makeError("invalid info type in flat data");
+        }
+    }
+
+private:
+    template<class T>
+    llvm::Expected<DecodedInfo>
+    finish()
+    {
+        DecodedInfo I = makeDecodedInfo<T>(arena_);
+        read(static_cast<T&>(*I));
+        if(failed_ || p_ != end_)
+            return makeError("malformed flat data");
+        return std::move(I);
+    }
+
+    bool
+    need(std::size_t n) noexcept
+    {
+        if(failed_ || static_cast<std::size_t>(end_ - p_) < n)
+        {
+            failed_ = true;
+            return false;
+        }
+        return true;
+    }
+
+    unsigned
+    get8() noexcept
+    {
+        if(! need(1))
+            return 0;
+        return static_cast<unsigned char>(*p_++);
+    }
+
+    std::uint32_t
+    get32() noexcept
+    {
+        if(! need(4))
+            return 0;
+        auto v = llvm::support::endian::read32le(p_);
+        p_ += 4;
+        return v;
+    }
+
+    bool
+    getBool() noexcept
+    {
+        return get8() != 0;
+    }
+
+    llvm::StringRef
+    getString() noexcept
+    {
+        std::uint32_t const i = get32();
+        if(failed_ || i >= tables_.stringCount)
+        {
+            failed_ = true;
+            return {};
+        }
+        std::uint32_t const first = llvm::support::endian::read32le(
+            tables_.offsets + 4 * i);
+        std::uint32_t const last = llvm::support::endian::read32le(
+            tables_.offsets + 4 * (i + 1));
+        if(first > last || last > tables_.charCount)
+        {
+            failed_ = true;
+            return {};
+        }
+        return llvm::StringRef(tables_.chars + first, last - first);
+    }
+
+    SymbolID
+    getSymbol() noexcept
+    {
+        std::uint32_t const i = get32();
+        SymbolID id = EmptySID;
+        if(failed_ || i >= tables_.symbolCount)
+        {
+            failed_ = true;
+            return id;
+        }
+        std::memcpy(id.data(),
+            tables_.symbols + id.size() * i, id.size());
+        return id;
+    }
+
+    template<class Enum>
+    void
+    getEnum(Enum& v) noexcept
+    {
+        v = static_cast<Enum>(get8());
+    }
+
+    template<class F>
+    void
+    getList(F const& f)
+    {
+        std::uint32_t const n = get32();
+        for(std::uint32_t i = 0; i < n && ! failed_; ++i)
+            f();
+    }
+
+    //--------------------------------------------
+
+    void
+    read(Location& L)
+    {
+        L.LineNumber = static_cast<int>(get32());
+        L.IsFileInRootDir = getBool();
+        L.Filename = getString();
+    }
+
+    void
+    read(Reference& R)
+    {
+        R.USR = getSymbol();
+        R.Name = getString();
+        getEnum(R.RefType);
+        R.Path = getString();
+    }
+
+    void
+    read(FieldTypeInfo& F)
+    {
+        read(F.Type);
+        F.Name = getString();
+        F.DefaultValue = getString();
+    }
+
+    void
+    read(MemberTypeInfo& M)
+    {
+        read(M.Type);
+        M.Name = getString();
+        getEnum(M.Access);
+        read(M.javadoc);
+    }
+
+    void
+    read(std::vector<TemplateParamInfo>& params)
+    {
+        getList([&]
+        {
+            params.emplace_back(getString());
+        });
+    }
+
+    void
+    read(llvm::Optional<TemplateInfo>& T)
+    {
+        if(! getBool())
+            return;
+        T.emplace();
+        read(T->Params);
+        if(! getBool())
+            return;
+        T->Specialization.emplace();
+        T->Specialization->SpecializationOf = getSymbol();
+        read(T->Specialization->Params);
+    }
+
+    void
+    read(Scope& S)
+    {
+        getList([&] { read(S.Namespaces.emplace_back()); });
+        getList([&] { read(S.Records.emplace_back()); });
+        getList([&] { read(S.Functions.emplace_back()); });
+        getList([&] { read(S.Enums.emplace_back()); });
+        getList([&] { read(S.Typedefs.emplace_back()); });
+    }
+
+    //--------------------------------------------
+
+    template<class T>
+    void
+    readParagraph(
+        T node,
+        List<Javadoc::Node>& list)
+    {
+        List<Javadoc::Node> children;
+        readNodes(children);
+        Javadoc::append(node.children, std::move(children));
+        Javadoc::append(list, std::move(node));
+    }
+
+    void
+    readNode(List<Javadoc::Node>& list)
+    {
+        Javadoc::Kind kind;
+        getEnum(kind);
+        switch(kind)
+        {
+        case Javadoc::Kind::text:
+            Javadoc::append(list, Javadoc::Text(getString().str()));
+            break;
+        case Javadoc::Kind::styled:
+        {
+            Javadoc::Style style;
+            getEnum(style);
+            Javadoc::append(list, Javadoc::StyledText(
+                getString().str(), style));
+            break;
+        }
+        case Javadoc::Kind::paragraph:
+            readParagraph(Javadoc::Paragraph(), list);
+            break;
+        case Javadoc::Kind::brief:
+            readParagraph(Javadoc::Brief(), list);
+            break;
+        case Javadoc::Kind::code:
+            readParagraph(Javadoc::Code(), list);
+            break;
+        case Javadoc::Kind::returns:
+            readParagraph(Javadoc::Returns(), list);
+            break;
+        case Javadoc::Kind::admonition:
+        {
+            Javadoc::Admonition node;
+            getEnum(node.style);
+            readParagraph(std::move(node), list);
+            break;
+        }
+        case Javadoc::Kind::param:
+        {
+            Javadoc::Param node;
+            node.name = getString().str();
+            readParagraph(std::move(node), list);
+            break;
+        }
+        case Javadoc::Kind::tparam:
+        {
+            Javadoc::TParam node;
+            node.name = getString().str();
+            readParagraph(std::move(node), list);
+            break;
+        }
+        default:
+            failed_ = true;
+            break;
+        }
+    }
+
+    void
+    readNodes(List<Javadoc::Node>& list)
+    {
+        getList([&] { readNode(list); });
+    }
+
+    void
+    read(Javadoc& jd)
+    {
+        List<Javadoc::Node> blocks;
+        readNodes(blocks);
+        Javadoc::append(jd.blocks_, std::move(blocks));
+
+        List<Javadoc::Node> params;
+        readNodes(params);
+        Javadoc::append(jd.params_, std::move(params));
+
+        List<Javadoc::Node> tparams;
+        readNodes(tparams);
+        Javadoc::append(jd.tparams_, std::move(tparams));
+
+        List<Javadoc::Node> returns;
+        readNodes(returns);
+        Javadoc::append(jd.returns_.children, std::move(returns));
+    }
+
+    //--------------------------------------------
+
+    void
+    readInfoPart(Info& I)
+    {
+        I.USR = getSymbol();
+        I.Name = getString();
+        I.Path = getString();
+        getList([&] { read(I.Namespace.emplace_back()); });
+        read(I.javadoc);
+    }
+
+    void
+    readSymbolPart(SymbolInfo& I)
+    {
+        readInfoPart(I);
+        if(getBool())
+        {
+            I.DefLoc.emplace();
+            read(*I.DefLoc);
+        }
+        getList([&] { read(I.Loc.emplace_back()); });
+    }
+
+    void
+    read(NamespaceInfo& I)
+    {
+        readInfoPart(I);
+        read(I.Children);
+    }
+
+    void
+    read(BaseRecordInfo& I)
+    {
+        I.USR = getSymbol();
+        I.Name = getString();
+        I.Path = getString();
+        getEnum(I.TagType);
+        I.IsVirtual = getBool();
+        getEnum(I.Access);
+        I.IsParent = getBool();
+        getList([&] { read(I.Members.emplace_back()); });
+    }
+
+    void
+    read(RecordInfo& I)
+    {
+        readSymbolPart(I);
+        getEnum(I.TagType);
+        I.IsTypeDef = getBool();
+        getList([&] { read(I.Members.emplace_back()); });
+        getList([&] { read(I.Parents.emplace_back()); });
+        getList([&] { read(I.VirtualParents.emplace_back()); });
+        getList([&] { read(I.Bases.emplace_back()); });
+        read(I.Children);
+        read(I.Template);
+    }
+
+    void
+    read(FunctionInfo& I)
+    {
+        readSymbolPart(I);
+        getEnum(I.Access);
+        I.IsMethod = getBool();
+        read(I.Parent);
+        read(I.ReturnType.Type);
+        getList([&] { read(I.Params.emplace_back()); });
+        read(I.Template);
+    }
+
+    void
+    read(EnumInfo& I)
+    {
+        readSymbolPart(I);
+        I.Scoped = getBool();
+        if(getBool())
+        {
+            I.BaseType.emplace();
+            read(I.BaseType->Type);
+        }
+        getList([&]
+        {
+            auto& V = I.Members.emplace_back();
+            V.Name = getString();
+            V.Value = getString();
+            V.ValueExpr = getString();
+        });
+    }
+
+    void
+    read(TypedefInfo& I)
+    {
+        readSymbolPart(I);
+        I.IsUsing = getBool();
+        read(I.Underlying.Type);
+    }
+};
+
+//------------------------------------------------
+
+class FlatDecoder : public InfoDecoder
+{
+    TUData const& tu_;
+    FlatTables tables_;
+
+public:
+    explicit
+    FlatDecoder(
+        TUData const& tu) noexcept
+        : tu_(tu)
+    {
+    }
+
+    llvm::Error
+    init()
+    {
+        namespace endian = llvm::support::endian;
+
+        auto const& data = tu_.data;
+        if( data.size() < PrologueSize ||
+            std::memcmp(data.data(), Magic, sizeof(Magic)) != 0)
+            return makeError("invalid flat data signature");
+        if(endian::read32le(data.data() + 4) != FlatVersion)
+            return makeError("unsupported flat data version");
+
+        // Each size is checked against the bytes
+        // which remain before it is used, so the
+        // reads below never leave the buffer.
+        char const* p = data.data() + tu_.tablesOffset;
+        char const* const end = data.data() + data.size();
+        auto remain = [&]() -> std::size_t
+        {
+            return end - p;
+        };
+        if(tu_.tablesOffset > data.size() || remain() < 4)
+            return makeError("malformed flat data tables");
+        tables_.stringCount = endian::read32le(p);
+        p += 4;
+        if(remain() / 4 <= tables_.stringCount)
+            return makeError("malformed flat data tables");
+        tables_.offsets = p;
+        p += 4 * (std::size_t(tables_.stringCount) + 1);
+        tables_.charCount = endian::read32le(
+            tables_.offsets + 4 * tables_.stringCount);
+        if(remain() < tables_.charCount)
+            return makeError("malformed flat data tables");
+        tables_.chars = p;
+        p += tables_.charCount;
+        if(remain() < 4)
+            return makeError("malformed flat data tables");
+        tables_.symbolCount = endian::read32le(p);
+        p += 4;
+        if(remain() != std::size_t(tables_.symbolCount) * sizeof(SymbolID))
+            return makeError("malformed flat data tables");
+        tables_.symbols = p;
+        return llvm::Error::success();
+    }
+
+    llvm::Expected<DecodedInfo>
+    read(
+        TUData::Slice const& slice,
+        InfoArena* arena) override
+    {
+        FlatReader reader(tables_, arena, tu_.slice(slice));
+        return reader.readInfo();
+    }
+};
+
+class FlatCodec : public Codec
+{
+public:
+    llvm::StringRef
+    name() const noexcept override
+    {
+        return "flat";
+    }
+
+    std::unique_ptr<InfoEncoder>
+    makeEncoder() const override
+    {
+        return std::make_unique<FlatWriter>();
+    }
+
+    llvm::Expected<std::unique_ptr<InfoDecoder>>
+    makeDecoder(
+        TUData const& tu,
+        Reporter&) const override
+    {
+        auto decoder = std::make_unique<FlatDecoder>(tu);
+        if(auto err = decoder->init())
+            return err;
+        return decoder;
+    }
+};
+
+} // (anon)
+
+//------------------------------------------------
+
+std::unique_ptr<Codec>
+makeFlatCodec()
+{
+    return std::make_unique<FlatCodec>();
+}
+
+} // mrdox
+} // clang
@@ -11,13 +11,21 @@
 
 #include "Commands.hpp"
 #include "utility.hpp"
+#include "ast/Codec.hpp"
+#include "ast/MemoryBudget.hpp"
 #include "ast/Serialize.hpp"
 #include "ast/FrontendAction.hpp"
 #include <mrdox/Corpus.hpp>
+#include <mrdox/Error.hpp>
 #include <clang/Index/USRGeneration.h>
 #include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/CompilerInstance.h>
 #include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
 #include <llvm/Support/Error.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/Path.h>
 
 #if 0
@@ -30,9 +38,16 @@
 //
 // This file implements the Mapper piece of the clang-doc tool. It implements
 // a RecursiveASTVisitor to look at each declaration and populate the info
-// into the internal representation. Each seen declaration is serialized to
-// to bitcode and written out to the ExecutionContext as a KV pair where the
-// key is the declaration's USR and the value is the serialized bitcode.
+// into the internal representation. Each seen declaration is serialized
+// as a top-level block of one bitstream for the whole translation unit,
+// which is handed to the results when the traversal is complete, along
+// with the location of the block for each declaration's USR.
+//
+// When the configuration names an AST manifest, translation units which
+// have a pre-built AST file are loaded from disk and handed directly to
+// the Visitor, skipping the parse. Stale or incompatible AST files are
+// rejected by the AST reader, in which case the translation unit is
+// parsed as usual.
 //
 
 namespace clang {
@@ -50,26 +65,36 @@ class Visitor
         bool include = true;
     };
 
-    tooling::ExecutionContext& exc_;
+    TUResults& results_;
+    MemoryBudget& budget_;
     Config const& config_;
     Reporter& R_;
+    std::unique_ptr<InfoEncoder> encoder_;
     std::unordered_map<
         clang::SourceLocation::UIntTy,
         FileFilter> fileFilter_;
+    SerializeCache cache_;
 
 public:
     Visitor(
-        tooling::ExecutionContext& exc,
+        TUResults& results,
+        MemoryBudget& budget,
+        JavadocCache& javadocs,
+        Codec const& codec,
         Config const& config,
-        Reporter& R) noexcept
-        : exc_(exc)
+        Reporter& R)
+        : results_(results)
+        , budget_(budget)
         , config_(config)
         , R_(R)
+        , encoder_(codec.makeEncoder())
+        , cache_(javadocs)
     {
     }
 
 //private:
     void HandleTranslationUnit(ASTContext& Context) override;
+    void recordMemory(ASTContext& Context, llvm::StringRef filePath);
     bool VisitNamespaceDecl(NamespaceDecl const* D);
     bool VisitRecordDecl(RecordDecl const* D);
     bool VisitEnumDecl(EnumDecl const* D);
@@ -111,11 +136,42 @@ HandleTranslationUnit(
             Context.getSourceManager().getMainFileID());
     if(filePath)
     {
+        recordMemory(Context, *filePath);
         llvm::SmallString<0> s(*filePath);
         convert_to_slash(s);
         if(config_.shouldVisitTU(s))
             TraverseDecl(Context.getTranslationUnitDecl());
     }
+
+    TUData data = encoder_->release();
+    if(! data.index.empty())
+        results_.add(std::move(data));
+}
+
+/*  The AST is complete at this point, so its
+    size is close to the peak for the whole
+    translation unit.
+*/
+void
+Visitor::
+recordMemory(
+    ASTContext& Context,
+    llvm::StringRef filePath)
+{
+    SourceManager const& SM = Context.getSourceManager();
+    std::uint64_t const bytes =
+        Context.getASTAllocatedMemory() +
+        Context.getSideTableAllocatedMemory() +
+        SM.getContentCacheSize() +
+        SM.getDataStructureSizes();
+    std::uint64_t fileSize = 0;
+    if(auto buffer = SM.getBufferOrNone(SM.getMainFileID()))
+        fileSize = buffer->getBufferSize();
+
+    llvm::SmallString<0> s(filePath);
+    if(SM.getFileManager().getVirtualFileSystem().makeAbsolute(s))
+        return;
+    budget_.record(s, fileSize, bytes);
 }
 
 template<typename T>
@@ -193,15 +249,16 @@ mapDecl(T const* D)
         filePath,
         IsFileInRootDir,
         ! config_.includePrivate(),
+        cache_,
         R_);
 
     // A null in place of I indicates that the
     // serializer is skipping this decl for some
     // reason (e.g. we're only reporting public decls).
     if (I.first)
-        Corpus::reportResult(exc_, *I.first);
+        encoder_->write(*I.first);
     if (I.second)
-        Corpus::reportResult(exc_, *I.second);
+        encoder_->write(*I.second);
 
     return true;
 }
@@ -281,10 +338,16 @@ struct Action
     : public clang::ASTFrontendAction
 {
     Action(
-        tooling::ExecutionContext& exc,
+        TUResults& results,
+        MemoryBudget& budget,
+        JavadocCache& javadocs,
+        Codec const& codec,
         Config const& config,
         Reporter& R) noexcept
-        : exc_(exc)
+        : results_(results)
+        , budget_(budget)
+        , javadocs_(javadocs)
+        , codec_(codec)
         , config_(config)
         , R_(R)
     {
@@ -295,48 +358,227 @@ struct Action
         clang::CompilerInstance& Compiler,
         llvm::StringRef InFile) override
     {
-        return std::make_unique<Visitor>(exc_, config_, R_);
+        return std::make_unique<Visitor>(
+            results_, budget_, javadocs_, codec_, config_, R_);
     }
 
 private:
-    tooling::ExecutionContext& exc_;
+    TUResults& results_;
+    MemoryBudget& budget_;
+    JavadocCache& javadocs_;
+    Codec const& codec_;
     Config const& config_;
     Reporter& R_;
 };
 
+/*  Maps source files to pre-built AST files.
+
+    The manifest is a JSON array of objects, each
+    having a "file" and an "ast" member. Relative
+    paths are resolved against the directory
+    containing the manifest.
+*/
+class ASTManifest
+{
+    llvm::StringMap<std::string> map_;
+
+    static
+    void
+    normalize(
+        llvm::SmallVectorImpl<char>& s,
+        llvm::StringRef dir)
+    {
+        namespace path = llvm::sys::path;
+
+        if(! path::is_absolute(s))
+        {
+            llvm::SmallString<0> temp(dir);
+            path::append(temp, llvm::StringRef(s.data(), s.size()));
+            s.assign(temp.begin(), temp.end());
+        }
+        path::remove_dots(s, true);
+        convert_to_slash(s);
+    }
+
+public:
+    llvm::Error
+    load(
+        llvm::StringRef filePath)
+    {
+        namespace path = llvm::sys::path;
+
+        auto fileText = llvm::MemoryBuffer::getFile(filePath);
+        if(! fileText)
+            return makeError(fileText.getError().message(),
+                " when loading file '", filePath, "'");
+        auto json = llvm::json::parse((*fileText)->getBuffer());
+        if(! json)
+            return json.takeError();
+        auto const* entries = json->getAsArray();
+        if(! entries)
+            return makeError("'", filePath, "' is not a JSON array");
+
+        llvm::StringRef dir = path::parent_path(filePath);
+        for(auto const& value : *entries)
+        {
+            auto const* entry = value.getAsObject();
+            if(! entry)
+                return makeError("'", filePath, "' has a malformed entry");
+            auto file = entry->getString("file");
+            auto ast = entry->getString("ast");
+            if(! file || ! ast)
+                return makeError("'", filePath, "' has an entry without \"file\" or \"ast\"");
+            llvm::SmallString<0> fileKey(*file);
+            llvm::SmallString<0> astPath(*ast);
+            normalize(fileKey, dir);
+            normalize(astPath, dir);
+            map_.insert_or_assign(fileKey.str(), astPath.str().str());
+        }
+        return llvm::Error::success();
+    }
+
+    /** Return the AST file for a source file, or an empty string.
+
+        @param filePath The posix-style full path
+        to the source file.
+    */
+    llvm::StringRef
+    find(
+        llvm::StringRef filePath) const noexcept
+    {
+        auto it = map_.find(filePath);
+        if(it == map_.end())
+            return {};
+        return it->second;
+    }
+
+    bool
+    empty() const noexcept
+    {
+        return map_.empty();
+    }
+};
+
+//------------------------------------------------
+
 struct Factory : tooling::FrontendActionFactory
 {
     Factory(
-        tooling::ExecutionContext& exc,
+        TUResults& results,
+        MemoryBudget& budget,
+        JavadocCache& javadocs,
+        Codec const& codec,
         Config const& config,
-        Reporter& R) noexcept
-        : exc_(exc)
+        Reporter& R)
+        : results_(results)
+        , budget_(budget)
+        , javadocs_(javadocs)
+        , codec_(codec)
         , config_(config)
         , R_(R)
     {
+        if(! config_.astManifest().empty())
+            if(R_.error(manifest_.load(config_.astManifest()),
+                    "load the AST manifest '", config_.astManifest(), "'"))
+                manifest_ = ASTManifest();
     }
 
     std::unique_ptr<FrontendAction>
     create() override
     {
-        return std::make_unique<Action>(exc_, config_, R_);
+        return std::make_unique<Action>(
+            results_, budget_, javadocs_, codec_, config_, R_);
+    }
+
+    bool
+    runInvocation(
+        std::shared_ptr<CompilerInvocation> Invocation,
+        FileManager* Files,
+        std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+        DiagnosticConsumer* DiagConsumer) override
+    {
+        if( ! manifest_.empty() &&
+            loadAST(*Invocation, *Files, *PCHContainerOps))
+            return true;
+        return tooling::FrontendActionFactory::runInvocation(
+            std::move(Invocation), Files,
+            std::move(PCHContainerOps), DiagConsumer);
     }
 
 private:
-    tooling::ExecutionContext& exc_;
+    /*  Visit the pre-built AST for the invocation, if any.
+
+        @return false if there is no usable AST file,
+        and the translation unit must be parsed.
+    */
+    bool
+    loadAST(
+        CompilerInvocation& Invocation,
+        FileManager& Files,
+        PCHContainerOperations& PCHContainerOps)
+    {
+        auto const& inputs = Invocation.getFrontendOpts().Inputs;
+        if(inputs.size() != 1 || ! inputs.front().isFile())
+            return false;
+
+        llvm::SmallString<0> filePath(inputs.front().getFile());
+        if(Files.getVirtualFileSystem().makeAbsolute(filePath))
+            return false;
+        llvm::sys::path::remove_dots(filePath, true);
+        convert_to_slash(filePath);
+        llvm::StringRef astPath = manifest_.find(filePath);
+        if(astPath.empty())
+            return false;
+
+        // The AST reader validates the compiler version
+        // and the modification times of every input file,
+        // so a stale or foreign AST simply fails to load.
+        // Its diagnostics are not interesting to the user.
+        IgnoringDiagConsumer ignore;
+        IntrusiveRefCntPtr<DiagnosticsEngine> Diags =
+            CompilerInstance::createDiagnostics(
+                &Invocation.getDiagnosticOpts(), &ignore, false);
+        std::unique_ptr<ASTUnit> unit = ASTUnit::LoadFromASTFile(
+            astPath.str(),
+            PCHContainerOps.getRawReader(),
+            ASTUnit::LoadEverything,
+            Diags,
+            Files.getFileSystemOpts());
+        if(! unit)
+        {
+            if(config_.verbose())
+                R_.print("warning: AST file '", astPath,
+                    "' is stale or incompatible, parsing '", filePath, "'");
+            return false;
+        }
+
+        Visitor visitor(results_, budget_, javadocs_, codec_, config_, R_);
+        visitor.HandleTranslationUnit(unit->getASTContext());
+        return true;
+    }
+
+    TUResults& results_;
+    MemoryBudget& budget_;
+    JavadocCache& javadocs_;
+    Codec const& codec_;
     Config const& config_;
     Reporter& R_;
+    ASTManifest manifest_;
 };
 
 } // (anon)
 
 std::unique_ptr<tooling::FrontendActionFactory>
 makeFrontendActionFactory(
-    tooling::ExecutionContext& exc,
+    TUResults& results,
+    MemoryBudget& budget,
+    JavadocCache& javadocs,
+    Codec const& codec,
     Config const& config,
     Reporter& R)
 {
-    return std::make_unique<Factory>(exc, config, R);
+    return std::make_unique<Factory>(
+        results, budget, javadocs, codec, config, R);
 }
 
 } // mrdox
@@ -12,9 +12,11 @@
 #ifndef MRDOX_FRONTEND_ACTION_HPP
 #define MRDOX_FRONTEND_ACTION_HPP
 
+#include "ast/Codec.hpp"
+#include "ast/MemoryBudget.hpp"
+#include "ast/ParseJavadoc.hpp"
 #include <mrdox/Config.hpp>
 #include <mrdox/Reporter.hpp>
-#include <clang/Tooling/Execution.h>
 #include <clang/Tooling/Tooling.h>
 #include <memory>
 
@@ -22,10 +24,29 @@ namespace clang {
 namespace mrdox {
 
 /** Return a factory used to visit the AST nodes.
+
+    @param results Receives the encoded Info for
+    each translation unit. Its lifetime must
+    extend until the factory is destroyed.
+
+    @param budget Receives the measured memory
+    of each translation unit. Its lifetime must
+    extend until the factory is destroyed.
+
+    @param javadocs The parsed comments shared by
+    every translation unit. Its lifetime must
+    extend until the factory is destroyed.
+
+    @param codec The codec used to encode the
+    Info. Its lifetime must extend until the
+    factory is destroyed.
 */
 std::unique_ptr<tooling::FrontendActionFactory>
 makeFrontendActionFactory(
-    tooling::ExecutionContext& exc,
+    TUResults& results,
+    MemoryBudget& budget,
+    JavadocCache& javadocs,
+    Codec const& codec,
     Config const& config,
     Reporter& R);
 
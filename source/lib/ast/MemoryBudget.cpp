@@ -0,0 +1,182 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "ast/MemoryBudget.hpp"
+#include "utility.hpp"
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/Path.h>
+#include <algorithm>
+#include <vector>
+
+namespace clang {
+namespace mrdox {
+
+MemoryBudget::
+MemoryBudget(
+    std::uint64_t budget,
+    std::size_t jobs,
+    TUStats& stats) noexcept
+    : stats_(stats)
+    , budget_(budget)
+    , initial_(budget / std::max<std::size_t>(jobs, 1))
+{
+}
+
+void
+MemoryBudget::
+normalize(
+    llvm::SmallVectorImpl<char>& path)
+{
+    llvm::sys::path::remove_dots(path, true);
+    convert_to_slash(path);
+}
+
+std::uint64_t
+MemoryBudget::
+inputSize(
+    llvm::StringRef key) const
+{
+    auto it = inputSizes_.find(key);
+    if(it != inputSizes_.end())
+        return it->second;
+    std::uint64_t size = 0;
+    if(llvm::sys::fs::file_size(key, size))
+        size = 0;
+    return size;
+}
+
+std::uint64_t
+MemoryBudget::
+estimate(
+    llvm::StringRef key,
+    std::uint64_t fileSize)
+{
+    if(std::uint64_t const peak = stats_.peak(key))
+        return peak;
+    if(samples_ == 0 || fileSize == 0)
+        return initial_;
+    return static_cast<std::uint64_t>(
+        bytesPerByte_ * static_cast<double>(fileSize));
+}
+
+void
+MemoryBudget::
+setInputSize(
+    llvm::StringRef filePath,
+    std::uint64_t size)
+{
+    llvm::SmallString<0> key(filePath);
+    normalize(key);
+    inputSizes_[key] = size;
+}
+
+std::uint64_t
+MemoryBudget::
+admit(
+    llvm::StringRef filePath)
+{
+    if(budget_ == 0)
+        return 0;
+
+    llvm::SmallString<0> key(filePath);
+    normalize(key);
+    std::uint64_t const fileSize = inputSize(key);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::uint64_t const n = estimate(key, fileSize);
+    cv_.wait(lock,
+        [&]
+        {
+            return
+                reserved_ == 0 ||
+                reserved_ + n <= budget_;
+        });
+    reserved_ += n;
+    return n;
+}
+
+void
+MemoryBudget::
+release(
+    std::uint64_t reserved)
+{
+    if(budget_ == 0)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reserved_ -= reserved;
+    }
+    cv_.notify_all();
+}
+
+void
+MemoryBudget::
+record(
+    llvm::StringRef filePath,
+    std::uint64_t fileSize,
+    std::uint64_t bytes)
+{
+    if(detached_)
+    {
+        detachedMeasurement_ = { fileSize, bytes };
+        return;
+    }
+    llvm::SmallString<0> key(filePath);
+    normalize(key);
+    auto it = inputSizes_.find(key);
+    if(it != inputSizes_.end())
+        fileSize = it->second;
+    stats_.recordPeak(key, bytes);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& e = entries_[key];
+    e.fileSize = fileSize;
+    e.peak = std::max(e.peak, bytes);
+    if(fileSize != 0)
+    {
+        // Running average of the memory
+        // used per byte of input.
+        ++samples_;
+        bytesPerByte_ += (
+            static_cast<double>(bytes) / fileSize -
+            bytesPerByte_) / samples_;
+    }
+}
+
+void
+MemoryBudget::
+report(
+    std::size_t count,
+    Reporter& R)
+{
+    std::vector<std::pair<llvm::StringRef, std::uint64_t>> peaks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        peaks.reserve(entries_.size());
+        for(auto const& e : entries_)
+            peaks.emplace_back(e.getKey(), e.getValue().peak);
+    }
+    if(peaks.empty())
+        return;
+    std::sort(peaks.begin(), peaks.end(),
+        [](auto const& p0, auto const& p1)
+        {
+            return p0.second > p1.second;
+        });
+    if(peaks.size() > count)
+        peaks.resize(count);
+    R.print("Peak memory per translation unit:");
+    for(auto const& [path, peak] : peaks)
+        R.print(llvm::format("%10.1f MB  ", peak / (1024.0 * 1024.0)), path);
+}
+
+} // mrdox
+} // clang
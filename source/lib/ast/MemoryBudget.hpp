@@ -0,0 +1,207 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_AST_MEMORYBUDGET_HPP
+#define MRDOX_SOURCE_AST_MEMORYBUDGET_HPP
+
+#include "ast/TUStats.hpp"
+#include <mrdox/Reporter.hpp>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace clang {
+namespace mrdox {
+
+/** Limits the memory used by translation units mapped at once.
+
+    Before a translation unit is parsed, its peak
+    memory is estimated, and it is admitted only
+    while the estimates of the translation units
+    being mapped fit in the budget. Otherwise the
+    worker waits, while other workers go on with
+    translation units which do fit. A translation
+    unit is always admitted when nothing else is
+    being mapped, even when it is over budget.
+
+    The memory of each translation unit is measured
+    as the size of its AST and source buffers, once
+    the AST is complete, and kept in the statistics
+    for the next run. The estimate for a translation
+    unit which was measured in a prior run is its
+    recorded peak. Otherwise, its input size is scaled
+    by the average ratio measured so far. The input
+    size of a file which is not on disk, such as an
+    umbrella translation unit, is set beforehand with
+    @ref setInputSize.
+
+    @par Thread Safety
+    May be called concurrently.
+*/
+class MemoryBudget
+{
+public:
+    /** A measurement taken in a forked worker process.
+    */
+    struct Measurement
+    {
+        std::uint64_t fileSize = 0;
+        std::uint64_t bytes = 0;
+    };
+
+private:
+    struct Entry
+    {
+        std::uint64_t fileSize = 0;
+        std::uint64_t peak = 0;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    llvm::StringMap<Entry> entries_;
+    llvm::StringMap<std::uint64_t> inputSizes_;
+    TUStats& stats_;
+    std::uint64_t budget_;
+    std::uint64_t initial_;
+    std::uint64_t reserved_ = 0;
+    double bytesPerByte_ = 0;
+    std::size_t samples_ = 0;
+    bool detached_ = false;
+    Measurement detachedMeasurement_;
+
+    static
+    void
+    normalize(
+        llvm::SmallVectorImpl<char>& path);
+
+    std::uint64_t
+    inputSize(
+        llvm::StringRef key) const;
+
+    std::uint64_t
+    estimate(
+        llvm::StringRef key,
+        std::uint64_t fileSize);
+
+public:
+    /** Constructor.
+
+        @param budget The budget in bytes, or
+        zero for no limit.
+
+        @param jobs The number of translation units
+        which may be mapped at once. Before any were
+        measured, each is estimated to use an equal
+        share of the budget.
+
+        @param stats The statistics which hold the
+        peaks of prior runs, and receive the peaks
+        of this one.
+    */
+    MemoryBudget(
+        std::uint64_t budget,
+        std::size_t jobs,
+        TUStats& stats) noexcept;
+
+    /** Set the input size of a file which is not on disk.
+
+        This must be called before mapping starts.
+
+        @param filePath The absolute path of the file.
+
+        @param size The size to estimate its memory
+        from. For a file which includes others, this
+        should count the included files too.
+    */
+    void
+    setInputSize(
+        llvm::StringRef filePath,
+        std::uint64_t size);
+
+    /** Wait until a translation unit fits in the budget.
+
+        @return The amount which was reserved, to
+        be passed to @ref release afterwards.
+
+        @param filePath The absolute path of the
+        main file of the translation unit.
+    */
+    std::uint64_t
+    admit(
+        llvm::StringRef filePath);
+
+    /** Return memory reserved by @ref admit to the budget.
+    */
+    void
+    release(
+        std::uint64_t reserved);
+
+    /** Record the measured memory of a translation unit.
+
+        @param filePath The absolute path of the
+        main file of the translation unit.
+
+        @param fileSize The size of the main file. This
+        is ignored if an input size was set for it.
+
+        @param bytes The memory used by the
+        translation unit.
+    */
+    void
+    record(
+        llvm::StringRef filePath,
+        std::uint64_t fileSize,
+        std::uint64_t bytes);
+
+    /** Stop recording in a forked worker process.
+
+        The lock may have been held by another
+        thread when the process was forked, so
+        a child must not take it. Instead, the
+        last measurement is kept, for the child
+        to send to the parent, which records it.
+    */
+    void
+    detach() noexcept
+    {
+        detached_ = true;
+    }
+
+    /** Return and clear the last measurement of a detached budget.
+
+        The measurement is zero if nothing was
+        recorded since the last call.
+    */
+    Measurement
+    takeMeasurement() noexcept
+    {
+        Measurement m = detachedMeasurement_;
+        detachedMeasurement_ = {};
+        return m;
+    }
+
+    /** Print the translation units which used the most memory.
+
+        @param count The largest number of
+        translation units to print.
+    */
+    void
+    report(
+        std::size_t count,
+        Reporter& R);
+};
+
+} // mrdox
+} // clang
+
+#endif
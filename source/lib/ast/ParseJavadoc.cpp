@@ -15,7 +15,10 @@
 #include <clang/AST/CommentCommandTraits.h>
 #include <clang/AST/ASTContext.h>
 #include <clang/AST/RawCommentList.h>
+#include <clang/Basic/SourceManager.h>
+#include <llvm/ADT/Hashing.h>
 #include <llvm/Support/JSON.h>
+#include <llvm/Support/xxhash.h>
 #include <cassert>
 
 #include <llvm/Support/Mutex.h>
@@ -665,13 +668,60 @@ dumpJavadoc(
         "\n\n";
 }
 
+//------------------------------------------------
+
+std::size_t
+JavadocCache::
+KeyHash::
+operator()(
+    Key const& key) const noexcept
+{
+    return static_cast<std::size_t>(llvm::hash_combine(
+        key.file.getDevice(), key.file.getFile(),
+        key.offset, key.hash));
+}
+
 Javadoc
-parseJavadoc(
+JavadocCache::
+parse(
     RawComment const* RC,
     ASTContext const& Ctx,
     Decl const* D)
 {
-    return JavadocVisitor(RC, Ctx, D).build();
+    SourceManager const& SM = Ctx.getSourceManager();
+    auto const loc = SM.getDecomposedLoc(RC->getBeginLoc());
+    FileEntry const* FE = SM.getFileEntryForID(loc.first);
+    if(! FE)
+        return JavadocVisitor(RC, Ctx, D).build();
+
+    Key const key{
+        FE->getUniqueID(),
+        loc.second,
+        llvm::xxHash64(RC->getRawText(SM)) };
+    Shard& shard = shards_[KeyHash()(key) % shards_.size()];
+    {
+        std::lock_guard<llvm::sys::Mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if(it != shard.map.end())
+            return it->second;
+    }
+
+    // Parse without holding the lock. If two threads
+    // parse the same comment, the first one wins.
+    Javadoc jd = JavadocVisitor(RC, Ctx, D).build();
+    std::lock_guard<llvm::sys::Mutex> lock(shard.mutex);
+    shard.map.try_emplace(key, jd);
+    return jd;
+}
+
+Javadoc
+parseJavadoc(
+    RawComment const* RC,
+    ASTContext const& Ctx,
+    Decl const* D,
+    JavadocCache& cache)
+{
+    return cache.parse(RC, Ctx, D);
 }
 
 } // mrdox
@@ -13,6 +13,11 @@
 #define MRDOX_SOURCE_PARSEJAVADOC_HPP
 
 #include <mrdox/meta/Javadoc.hpp>
+#include <llvm/Support/FileSystem/UniqueID.h>
+#include <llvm/Support/Mutex.h>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
 
 namespace clang {
 
@@ -24,6 +29,56 @@ namespace mrdox {
 
 struct Javadoc;
 
+/** Parsed comments shared by the translation units of one build.
+
+    A comment in a header is seen once from every
+    translation unit which includes the header. The
+    file's unique ID and the offset of the comment
+    identify it across translation units, while the
+    hash of the text guards against a file which
+    changed between translation units.
+
+    The cache is owned by the build and dropped
+    when mapping ends, so its entries never outlive
+    the files they were read from.
+*/
+class JavadocCache
+{
+    struct Key
+    {
+        llvm::sys::fs::UniqueID file;
+        unsigned offset;
+        std::uint64_t hash;
+
+        bool operator==(Key const&) const = default;
+    };
+
+    struct KeyHash
+    {
+        std::size_t
+        operator()(Key const& key) const noexcept;
+    };
+
+    struct Shard
+    {
+        llvm::sys::Mutex mutex;
+        std::unordered_map<Key, Javadoc, KeyHash> map;
+    };
+
+    std::array<Shard, 16> shards_;
+
+public:
+    /** Return the parsed comment, parsing it if it is not cached.
+
+        This may be called concurrently.
+    */
+    Javadoc
+    parse(
+        RawComment const* RC,
+        ASTContext const& Ctx,
+        Decl const* D);
+};
+
 void
 dumpJavadoc(
     Javadoc const& jd);
@@ -32,7 +87,8 @@ Javadoc
 parseJavadoc(
     RawComment const* RC,
     ASTContext const& Ctx,
-    Decl const* D);
+    Decl const* D,
+    JavadocCache& cache);
 
 } // mrdox
 } // clang
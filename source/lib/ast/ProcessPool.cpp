@@ -0,0 +1,473 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "ast/ProcessPool.hpp"
+#include <mrdox/Error.hpp>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mutex>
+
+#ifdef LLVM_ON_UNIX
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// The messages between the parent and a child are:
+//
+//  parent -> child
+//      u32             index of the translation unit
+//
+//  child -> parent
+//      u8              1 if the action succeeded
+//      u64             size of the main file
+//      u64             memory measured, or 0
+//      u32             number of TUData
+//      for each TUData:
+//          u32         tablesOffset
+//          u32         number of slices
+//          u32         size of the data
+//          Slice[]     the index, as raw bytes
+//          char[]      the data
+//
+// Both processes run the same program,
+// so the slices are copied as they are.
+//
+
+namespace clang {
+namespace mrdox {
+
+struct ProcessPool::Worker
+{
+    int pid = -1;
+    int toChild = -1;
+    int fromChild = -1;
+};
+
+#ifdef LLVM_ON_UNIX
+
+namespace {
+
+enum class ReadResult
+{
+    ok,
+    eof,
+    timeout
+};
+
+bool
+writeAll(
+    int fd,
+    void const* data,
+    std::size_t size)
+{
+    auto p = static_cast<char const*>(data);
+    while(size > 0)
+    {
+        ssize_t const n = ::write(fd, p, size);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            return false;
+        }
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/*  Write to a child without raising SIGPIPE
+    if the child exited, which would end this
+    process. The signal is only blocked in the
+    calling thread, and one raised by the write
+    is consumed before it is unblocked.
+*/
+bool
+writeToChild(
+    int fd,
+    void const* data,
+    std::size_t size)
+{
+    sigset_t pipeSet;
+    sigemptyset(&pipeSet);
+    sigaddset(&pipeSet, SIGPIPE);
+    sigset_t pending;
+    sigpending(&pending);
+    bool const wasPending = sigismember(&pending, SIGPIPE);
+    sigset_t old;
+    pthread_sigmask(SIG_BLOCK, &pipeSet, &old);
+
+    bool const ok = writeAll(fd, data, size);
+    if(! ok && ! wasPending)
+    {
+        sigpending(&pending);
+        if(sigismember(&pending, SIGPIPE))
+        {
+            int sig;
+            sigwait(&pipeSet, &sig);
+        }
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old, nullptr);
+    return ok;
+}
+
+ReadResult
+readAll(
+    int fd,
+    void* data,
+    std::size_t size,
+    std::chrono::steady_clock::time_point const* deadline)
+{
+    using clock = std::chrono::steady_clock;
+
+    auto p = static_cast<char*>(data);
+    while(size > 0)
+    {
+        if(deadline)
+        {
+            auto const left = std::chrono::duration_cast<
+                std::chrono::milliseconds>(*deadline - clock::now());
+            if(left.count() <= 0)
+                return ReadResult::timeout;
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            int const r = ::poll(&pfd, 1, static_cast<int>(left.count()));
+            if(r < 0 && errno == EINTR)
+                continue;
+            if(r == 0)
+                return ReadResult::timeout;
+        }
+        ssize_t const n = ::read(fd, p, size);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            return ReadResult::eof;
+        }
+        if(n == 0)
+            return ReadResult::eof;
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return ReadResult::ok;
+}
+
+template<class T>
+void
+append(
+    std::string& buf,
+    T const& v)
+{
+    buf.append(reinterpret_cast<char const*>(&v), sizeof(v));
+}
+
+} // (anon)
+
+bool
+ProcessPool::
+isSupported() noexcept
+{
+    return true;
+}
+
+ProcessPool::
+ProcessPool(
+    std::size_t workers,
+    TUResults& results,
+    std::function<Outcome(std::size_t)> job,
+    std::function<void()> atFork,
+    std::chrono::seconds timeout)
+    : results_(results)
+    , job_(std::move(job))
+    , atFork_(std::move(atFork))
+    , timeout_(timeout)
+    , workers_(workers)
+{
+}
+
+ProcessPool::
+~ProcessPool()
+{
+    // Closing the pipe tells the child to exit.
+    for(auto& w : workers_)
+    {
+        if(w.pid < 0)
+            continue;
+        ::close(w.toChild);
+        int status;
+        while(::waitpid(w.pid, &status, 0) < 0 && errno == EINTR)
+        {
+        }
+        ::close(w.fromChild);
+    }
+}
+
+llvm::Error
+ProcessPool::
+spawn(
+    Worker& w)
+{
+    int toChild[2];
+    int fromChild[2];
+    if(::pipe(toChild) != 0)
+        return makeError("pipe returned ", std::strerror(errno));
+    if(::pipe(fromChild) != 0)
+    {
+        int const ec = errno;
+        ::close(toChild[0]);
+        ::close(toChild[1]);
+        return makeError("pipe returned ", std::strerror(ec));
+    }
+
+    // Anything left in the buffers would
+    // otherwise be written by the child too.
+    llvm::outs().flush();
+    llvm::errs().flush();
+
+    int const pid = ::fork();
+    if(pid < 0)
+    {
+        int const ec = errno;
+        ::close(toChild[0]);
+        ::close(toChild[1]);
+        ::close(fromChild[0]);
+        ::close(fromChild[1]);
+        return makeError("fork returned ", std::strerror(ec));
+    }
+    if(pid == 0)
+    {
+        // A child must not hold the pipes of the
+        // other children open, or they would never
+        // see the end of their input.
+        for(auto& other : workers_)
+        {
+            if(other.pid < 0)
+                continue;
+            ::close(other.toChild);
+            ::close(other.fromChild);
+        }
+        ::close(toChild[1]);
+        ::close(fromChild[0]);
+        // The results which the parent collected
+        // so far belong to it. The child must only
+        // send back what it maps itself. The lock
+        // in the results is free, since adding to
+        // them takes the fork mutex.
+        results_.take();
+        if(atFork_)
+            atFork_();
+        childMain(toChild[0], fromChild[1]);
+    }
+    ::close(toChild[0]);
+    ::close(fromChild[1]);
+    w.pid = pid;
+    w.toChild = toChild[1];
+    w.fromChild = fromChild[0];
+    return llvm::Error::success();
+}
+
+void
+ProcessPool::
+childMain(
+    int in,
+    int out)
+{
+    std::string buf;
+    for(;;)
+    {
+        std::uint32_t index;
+        if(readAll(in, &index, sizeof(index), nullptr) != ReadResult::ok)
+            break;
+
+        Outcome const outcome = job_(index);
+        std::vector<TUData> tus = results_.take();
+
+        buf.clear();
+        append(buf, static_cast<std::uint8_t>(outcome.ok ? 1 : 0));
+        append(buf, outcome.fileSize);
+        append(buf, outcome.memory);
+        append(buf, static_cast<std::uint32_t>(tus.size()));
+        for(auto const& tu : tus)
+        {
+            append(buf, tu.tablesOffset);
+            append(buf, static_cast<std::uint32_t>(tu.index.size()));
+            append(buf, static_cast<std::uint32_t>(tu.data.size()));
+            buf.append(reinterpret_cast<char const*>(tu.index.data()),
+                tu.index.size() * sizeof(TUData::Slice));
+            buf.append(tu.data.data(), tu.data.size());
+        }
+        if(! writeAll(out, buf.data(), buf.size()))
+            break;
+    }
+
+    // Nothing which the parent owns may be
+    // cleaned up here, so no destructors run.
+    llvm::outs().flush();
+    llvm::errs().flush();
+    ::_exit(0);
+}
+
+llvm::Error
+ProcessPool::
+reap(
+    Worker& w,
+    bool timedOut)
+{
+    if(timedOut)
+        ::kill(w.pid, SIGKILL);
+    int const pid = w.pid;
+    {
+        // A child forked by another thread closes
+        // the pipes of every worker, so they must
+        // not be freed while it reads the list.
+        // Their numbers are reused by the next pipe.
+        std::unique_lock<std::shared_mutex> lock(forkMutex_);
+        ::close(w.toChild);
+        ::close(w.fromChild);
+        w = Worker();
+    }
+    int status = 0;
+    while(::waitpid(pid, &status, 0) < 0 && errno == EINTR)
+    {
+    }
+
+    if(timedOut)
+        return makeError("worker process ", pid, " timed out after ",
+            static_cast<long long>(timeout_.count()), "s");
+    if(WIFSIGNALED(status))
+        return makeError("worker process ", pid, " crashed with signal ",
+            WTERMSIG(status), " (", ::strsignal(WTERMSIG(status)), ")");
+    return makeError("worker process ", pid, " exited with status ",
+        WEXITSTATUS(status));
+}
+
+llvm::Expected<ProcessPool::Outcome>
+ProcessPool::
+run(
+    std::size_t worker,
+    std::size_t index)
+{
+    using clock = std::chrono::steady_clock;
+
+    Worker& w = workers_[worker];
+    if(w.pid < 0)
+    {
+        std::unique_lock<std::shared_mutex> lock(forkMutex_);
+        if(auto err = spawn(w))
+            return err;
+    }
+
+    auto const i = static_cast<std::uint32_t>(index);
+    if(! writeToChild(w.toChild, &i, sizeof(i)))
+        return reap(w, false);
+
+    auto const deadline = clock::now() + timeout_;
+    auto const* pdeadline = timeout_.count() != 0 ? &deadline : nullptr;
+    auto read = [&](void* data, std::size_t size) -> llvm::Error
+    {
+        switch(readAll(w.fromChild, data, size, pdeadline))
+        {
+        case ReadResult::ok:
+            return llvm::Error::success();
+        case ReadResult::timeout:
+            return reap(w, true);
+        default:
+            return reap(w, false);
+        }
+    };
+
+    std::uint8_t ok;
+    Outcome outcome;
+    std::uint32_t count;
+    if(auto err = read(&ok, sizeof(ok)))
+        return err;
+    if(auto err = read(&outcome.fileSize, sizeof(outcome.fileSize)))
+        return err;
+    if(auto err = read(&outcome.memory, sizeof(outcome.memory)))
+        return err;
+    if(auto err = read(&count, sizeof(count)))
+        return err;
+    std::vector<TUData> tus(count);
+    for(auto& tu : tus)
+    {
+        std::uint32_t slices;
+        std::uint32_t size;
+        if(auto err = read(&tu.tablesOffset, sizeof(tu.tablesOffset)))
+            return err;
+        if(auto err = read(&slices, sizeof(slices)))
+            return err;
+        if(auto err = read(&size, sizeof(size)))
+            return err;
+        tu.index.resize(slices);
+        tu.data.resize(size);
+        if(auto err = read(tu.index.data(), slices * sizeof(TUData::Slice)))
+            return err;
+        if(auto err = read(tu.data.data(), size))
+            return err;
+    }
+
+    // Adding takes the lock in the results,
+    // which a child must not inherit locked.
+    std::shared_lock<std::shared_mutex> lock(forkMutex_);
+    for(auto& tu : tus)
+        results_.add(std::move(tu));
+    outcome.ok = ok != 0;
+    return outcome;
+}
+
+#else
+
+bool
+ProcessPool::
+isSupported() noexcept
+{
+    return false;
+}
+
+ProcessPool::
+ProcessPool(
+    std::size_t workers,
+    TUResults& results,
+    std::function<Outcome(std::size_t)> job,
+    std::function<void()> atFork,
+    std::chrono::seconds timeout)
+    : results_(results)
+    , job_(std::move(job))
+    , atFork_(std::move(atFork))
+    , timeout_(timeout)
+    , workers_(workers)
+{
+}
+
+ProcessPool::
+~ProcessPool() = default;
+
+llvm::Expected<ProcessPool::Outcome>
+ProcessPool::
+run(
+    std::size_t,
+    std::size_t)
+{
+    return makeError("worker processes are not supported on this platform");
+}
+
+#endif
+
+} // mrdox
+} // clang
@@ -0,0 +1,147 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_AST_PROCESSPOOL_HPP
+#define MRDOX_SOURCE_AST_PROCESSPOOL_HPP
+
+#include "ast/Codec.hpp"
+#include <llvm/Support/Error.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <vector>
+
+namespace clang {
+namespace mrdox {
+
+/** Maps translation units in forked worker processes.
+
+    Each worker thread of the map phase owns one
+    child process, which is forked from this one
+    and thus shares its compilation database and
+    frontend action. The child maps the translation
+    units it is sent, and streams the encoded data
+    of each one back over a pipe. A child which
+    crashes or hangs takes only its translation
+    unit down with it, and is replaced by a new
+    one the next time its worker needs it.
+
+    Forking a process which has other threads is
+    only safe if no lock which the child needs is
+    held at that moment. Any thread which takes a
+    lock that the children also use, such as the
+    one in the @ref Reporter, must first take
+    @ref forkMutex for shared ownership.
+
+    This is only available on POSIX systems.
+*/
+class ProcessPool
+{
+public:
+    /** The outcome of mapping one translation unit in a child.
+    */
+    struct Outcome
+    {
+        /** False if the action failed.
+        */
+        bool ok = false;
+
+        /** The size of the main file, as measured by the child.
+        */
+        std::uint64_t fileSize = 0;
+
+        /** The memory measured by the child, or zero if none was.
+        */
+        std::uint64_t memory = 0;
+    };
+
+private:
+    struct Worker;
+
+    TUResults& results_;
+    std::function<Outcome(std::size_t)> job_;
+    std::function<void()> atFork_;
+    std::chrono::seconds timeout_;
+    std::shared_mutex forkMutex_;
+    std::vector<Worker> workers_;
+
+    llvm::Error spawn(Worker& w);
+    llvm::Error reap(Worker& w, bool timedOut);
+    [[noreturn]] void childMain(int in, int out);
+
+public:
+    /** Return true if worker processes are available on this platform.
+    */
+    static
+    bool
+    isSupported() noexcept;
+
+    /** Constructor.
+
+        @param workers The number of worker processes.
+
+        @param results The results which the frontend
+        action adds to. In a child, the data it adds is
+        sent to the parent, which adds it here.
+
+        @param job The function which maps one
+        translation unit in a child, returning
+        whether the action succeeded and what it
+        measured.
+
+        @param atFork A function which is called in
+        every child right after it is forked.
+
+        @param timeout The time after which a child is
+        considered to hang, or zero for no limit.
+    */
+    ProcessPool(
+        std::size_t workers,
+        TUResults& results,
+        std::function<Outcome(std::size_t)> job,
+        std::function<void()> atFork,
+        std::chrono::seconds timeout);
+
+    /** Destructor.
+
+        The children are told to exit, and waited for.
+    */
+    ~ProcessPool();
+
+    /** Return the mutex which serializes forking.
+    */
+    std::shared_mutex&
+    forkMutex() noexcept
+    {
+        return forkMutex_;
+    }
+
+    /** Map one translation unit in a worker process.
+
+        @return The outcome which the child sent, or
+        an error if the child crashed or did not
+        answer in time.
+
+        @param worker The worker, which must not be
+        used by another thread at the same time.
+
+        @param index The argument to the job.
+    */
+    llvm::Expected<Outcome>
+    run(
+        std::size_t worker,
+        std::size_t index);
+};
+
+} // mrdox
+} // clang
+
+#endif
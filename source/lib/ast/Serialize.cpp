@@ -10,7 +10,6 @@
 //
 
 #include "Serialize.hpp"
-#include "BitcodeWriter.hpp"
 #include "ParseJavadoc.hpp"
 #include <mrdox/Metadata.hpp>
 #include <clang/Index/USRGeneration.h>
@@ -32,7 +31,8 @@ static void
 populateParentNamespaces(llvm::SmallVector<Reference, 4>& Namespaces,
     const T* D, bool& IsAnonymousNamespace);
 
-static void populateMemberTypeInfo(MemberTypeInfo& I, const FieldDecl* D, Reporter& R);
+static void populateMemberTypeInfo(MemberTypeInfo& I, const FieldDecl* D,
+    SerializeCache& cache, Reporter& R);
 
 // A function to extract the appropriate relative path for a given info's
 // documentation. The path returned is a composite of the parent namespaces.
@@ -74,38 +74,6 @@ std::string getSourceCode(const Decl* D, const SourceRange& R) {
         .str();
 }
 
-template <typename T>
-static
-std::string
-serialize(T& I)
-{
-    SmallString<2048> Buffer;
-    llvm::BitstreamWriter Stream(Buffer);
-    BitcodeWriter Writer(Stream);
-    Writer.emitBlock(I);
-    return Buffer.str().str();
-}
-
-std::string
-serialize(Info const& I)
-{
-    switch (I.IT)
-    {
-    case InfoType::IT_namespace:
-        return serialize(*static_cast<NamespaceInfo const*>(&I));
-    case InfoType::IT_record:
-        return serialize(*static_cast<RecordInfo const*>(&I));
-    case InfoType::IT_enum:
-        return serialize(*static_cast<EnumInfo const*>(&I));
-    case InfoType::IT_function:
-        return serialize(*static_cast<FunctionInfo const*>(&I));
-    //case InfoType::IT_typedef:
-        //return serialize(*static_cast<TypedefInfo const*>(&I));
-    default:
-        return "";
-    }
-}
-
 static
 SymbolID
 getUSRForDecl(
@@ -353,6 +321,7 @@ parseFields(
     const RecordDecl* D,
     bool PublicOnly,
     AccessSpecifier Access,
+    SerializeCache& cache,
     Reporter& R)
 {
     for (const FieldDecl* F : D->fields())
@@ -366,7 +335,7 @@ parseFields(
             getTypeInfoForType(F->getTypeSourceInfo()->getType()),
             F->getNameAsString(),
             getFinalAccessSpecifier(Access, F->getAccessUnsafe()));
-        populateMemberTypeInfo(NewMember, F, R);
+        populateMemberTypeInfo(NewMember, F, cache, R);
     }
 }
 
@@ -584,6 +553,7 @@ void
 populateMemberTypeInfo(
     MemberTypeInfo& I,
     const FieldDecl* D,
+    SerializeCache& cache,
     Reporter& R)
 {
     assert(D && "Expect non-null FieldDecl in populateMemberTypeInfo");
@@ -595,7 +565,7 @@ populateMemberTypeInfo(
     if(RC)
     {
         RC->setAttached();
-        I.javadoc = parseJavadoc(RC, D->getASTContext(), D);
+        I.javadoc = parseJavadoc(RC, D->getASTContext(), D, cache.Javadocs);
     }
 }
 
@@ -608,6 +578,7 @@ parseBases(
     bool PublicOnly,
     bool IsParent,
     AccessSpecifier ParentAccess,
+    SerializeCache& cache,
     Reporter& R)
 {
     // Don't parse bases if this isn't a definition.
@@ -637,33 +608,41 @@ parseBases(
                     BI.USR = getUSRForDecl(Base);
                     BI.Name = Base->getNameAsString();
                 }
-                parseFields(BI, Base, PublicOnly, BI.Access, R);
-                for (const auto& Decl : Base->decls())
+                // The inherited members only depend on the base
+                // and the effective access, so each base is
+                // walked once per translation unit.
+                auto const key = std::make_pair(
+                    Base, static_cast<unsigned>(BI.Access));
+                auto it = cache.Bases.find(key);
+                if (it == cache.Bases.end())
                 {
-                    if (const auto* MD = dyn_cast<CXXMethodDecl>(Decl))
+                    SerializeCache::BaseMembers Inherited;
+                    {
+                        RecordInfo Fields;
+                        parseFields(Fields, Base, PublicOnly, BI.Access, cache, R);
+                        Inherited.Fields = std::move(Fields.Members);
+                    }
+                    for (const auto& Decl : Base->decls())
                     {
-                        // Don't serialize private methods
-                        if (MD->getAccessUnsafe() == AccessSpecifier::AS_private ||
-                            !MD->isUserProvided())
-                            continue;
-                        FunctionInfo FI;
-                        FI.IsMethod = true;
-                        // The seventh arg in populateFunctionInfo is a boolean passed by
-                        // reference, its value is not relevant in here so it's not used
-                        // anywhere besides the function call.
-                        bool IsInAnonymousNamespace;
-                        populateFunctionInfo(FI, MD, Javadoc(), /*LineNumber=*/{},
-                            /*FileName=*/{}, IsFileInRootDir,
-                            IsInAnonymousNamespace, R);
-                        FI.Access =
-                            getFinalAccessSpecifier(BI.Access, MD->getAccessUnsafe());
-                        BI.Children.Functions.emplace_back(
-                            FI.USR,
-                            FI.Name,
-                            InfoType::IT_function,
-                            FI.Path);
+                        if (const auto* MD = dyn_cast<CXXMethodDecl>(Decl))
+                        {
+                            // Don't serialize private methods
+                            if (MD->getAccessUnsafe() == AccessSpecifier::AS_private ||
+                                !MD->isUserProvided())
+                                continue;
+                            // Only the reference is kept, so there is
+                            // no need to build the whole FunctionInfo.
+                            Inherited.Functions.emplace_back(
+                                getUSRForDecl(MD),
+                                MD->getNameAsString(),
+                                InfoType::IT_function);
+                        }
                     }
+                    it = cache.Bases.try_emplace(
+                        key, std::move(Inherited)).first;
                 }
+                BI.Members = it->second.Fields;
+                BI.Children.Functions = it->second.Functions;
                 I.Bases.emplace_back(std::move(BI));
                 // Call this function recursively to get the inherited classes of
                 // this base; these new bases will also get stored in the original
@@ -674,7 +653,7 @@ parseBases(
                 //
             #if 0
                 parseBases(I, Base, IsFileInRootDir, PublicOnly, false,
-                    I.Bases.back().Access, R);
+                    I.Bases.back().Access, cache, R);
             #endif
             }
         }
@@ -691,6 +670,7 @@ buildInfo(
     llvm::StringRef File,
     bool IsFileInRootDir,
     bool PublicOnly,
+    SerializeCache& cache,
     Reporter& R)
 {
     auto I = std::make_unique<NamespaceInfo>();
@@ -720,6 +700,7 @@ buildInfo(
     llvm::StringRef File,
     bool IsFileInRootDir,
     bool PublicOnly,
+    SerializeCache& cache,
     Reporter& R)
 {
     auto I = std::make_unique<RecordInfo>();
@@ -730,7 +711,7 @@ buildInfo(
         return {};
 
     I->TagType = D->getTagKind();
-    parseFields(*I, D, PublicOnly, AccessSpecifier::AS_public, R);
+    parseFields(*I, D, PublicOnly, AccessSpecifier::AS_public, cache, R);
     if (const auto* C = dyn_cast<CXXRecordDecl>(D))
     {
         if (const TypedefNameDecl* TD = C->getTypedefNameForAnonDecl())
@@ -740,7 +721,8 @@ buildInfo(
         }
         // TODO: remove first call to parseBases, that function should be deleted
         parseBases(*I, C);
-        parseBases(*I, C, IsFileInRootDir, PublicOnly, true, AccessSpecifier::AS_public, R);
+        parseBases(*I, C, IsFileInRootDir, PublicOnly, true,
+            AccessSpecifier::AS_public, cache, R);
     }
     I->Path = getInfoRelativePath(I->Namespace);
 
@@ -809,6 +791,7 @@ buildInfo(
     llvm::StringRef File,
     bool IsFileInRootDir,
     bool PublicOnly,
+    SerializeCache& cache,
     Reporter& R)
 {
     auto up = std::make_unique<FunctionInfo>();
@@ -835,6 +818,7 @@ buildInfo(
     llvm::StringRef File,
     bool IsFileInRootDir,
     bool PublicOnly,
+    SerializeCache& cache,
     Reporter& R)
 {
     auto up = std::make_unique<FunctionInfo>();
@@ -874,6 +858,7 @@ buildInfo(
     StringRef File,
     bool IsFileInRootDir,
     bool PublicOnly,
+    SerializeCache& cache,
     Reporter& R)
 {
     TypedefInfo Info;
@@ -913,6 +898,7 @@ buildInfo(
     StringRef File,
     bool IsFileInRootDir,
     bool PublicOnly,
+    SerializeCache& cache,
     Reporter& R)
 {
     TypedefInfo Info;
@@ -940,6 +926,7 @@ buildInfo(
     llvm::StringRef File,
     bool IsFileInRootDir,
     bool PublicOnly,
+    SerializeCache& cache,
     Reporter& R)
 {
     EnumInfo Enum;
@@ -23,13 +23,50 @@
 #include <mrdox/MetadataFwd.hpp>
 #include <mrdox/Reporter.hpp>
 #include <mrdox/meta/Javadoc.hpp>
+#include <mrdox/meta/MemberType.hpp>
+#include <mrdox/meta/Reference.hpp>
 #include <clang/AST/AST.h>
+#include <llvm/ADT/DenseMap.h>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace clang {
 namespace mrdox {
 
+/** Memoized results used while building Info for one translation unit.
+
+    Entries are keyed by decl, so an instance must
+    not outlive the translation unit it is used with.
+*/
+struct SerializeCache
+{
+    explicit
+    SerializeCache(
+        JavadocCache& javadocs) noexcept
+        : Javadocs(javadocs)
+    {
+    }
+
+    /** Parsed comments, shared by the whole build.
+    */
+    JavadocCache& Javadocs;
+
+    /** The members a derived class inherits from a base.
+    */
+    struct BaseMembers
+    {
+        llvm::SmallVector<MemberTypeInfo, 4> Fields;
+        std::vector<Reference> Functions;
+    };
+
+    /** Inherited members keyed by base and effective access.
+    */
+    llvm::DenseMap<
+        std::pair<CXXRecordDecl const*, unsigned>,
+        BaseMembers> Bases;
+};
+
 // The first element will contain the relevant information about the declaration
 // passed as parameter.
 // The second element will contain the relevant information about the
@@ -41,39 +78,51 @@ namespace mrdox {
 // nullptr.
 std::pair<std::unique_ptr<Info>, std::unique_ptr<Info>>
 buildInfo(NamespaceDecl const* D, Javadoc jd, int LineNumber,
-         StringRef File, bool IsFileInRootDir, bool PublicOnly, Reporter& R);
+         StringRef File, bool IsFileInRootDir, bool PublicOnly,
+         SerializeCache& cache, Reporter& R);
 
 std::pair<std::unique_ptr<Info>, std::unique_ptr<Info>>
 buildInfo(RecordDecl const* D, Javadoc jd, int LineNumber,
-         StringRef File, bool IsFileInRootDir, bool PublicOnly, Reporter& R);
+         StringRef File, bool IsFileInRootDir, bool PublicOnly,
+         SerializeCache& cache, Reporter& R);
 
 std::pair<std::unique_ptr<Info>, std::unique_ptr<Info>>
 buildInfo(EnumDecl const* D, Javadoc jd, int LineNumber,
-         StringRef File, bool IsFileInRootDir, bool PublicOnly, Reporter& R);
+         StringRef File, bool IsFileInRootDir, bool PublicOnly,
+         SerializeCache& cache, Reporter& R);
 
 std::pair<std::unique_ptr<Info>, std::unique_ptr<Info>>
 buildInfo(FunctionDecl const* D, Javadoc jd, int LineNumber,
-         StringRef File, bool IsFileInRootDir, bool PublicOnly, Reporter& R);
+         StringRef File, bool IsFileInRootDir, bool PublicOnly,
+         SerializeCache& cache, Reporter& R);
 
 std::pair<std::unique_ptr<Info>, std::unique_ptr<Info>>
 buildInfo(CXXMethodDecl const* D, Javadoc jd, int LineNumber,
-         StringRef File, bool IsFileInRootDir, bool PublicOnly, Reporter& R);
+         StringRef File, bool IsFileInRootDir, bool PublicOnly,
+         SerializeCache& cache, Reporter& R);
 
 std::pair<std::unique_ptr<Info>, std::unique_ptr<Info>>
 buildInfo(TypedefDecl const* D, Javadoc jd, int LineNumber,
-         StringRef File, bool IsFileInRootDir, bool PublicOnly, Reporter& R);
+         StringRef File, bool IsFileInRootDir, bool PublicOnly,
+         SerializeCache& cache, Reporter& R);
 
 std::pair<std::unique_ptr<Info>, std::unique_ptr<Info>>
 buildInfo(TypeAliasDecl const* D, Javadoc jd, int LineNumber,
-         StringRef File, bool IsFileInRootDir, bool PublicOnly, Reporter& R);
+         StringRef File, bool IsFileInRootDir, bool PublicOnly,
+         SerializeCache& cache, Reporter& R);
 
-template<class Decl, class... Args>
+template<class Decl>
 std::pair<
     std::unique_ptr<Info>,
     std::unique_ptr<Info>>
 buildInfoPair(
     Decl const* D,
-    Args&&... args)
+    int LineNumber,
+    StringRef File,
+    bool IsFileInRootDir,
+    bool PublicOnly,
+    SerializeCache& cache,
+    Reporter& R)
 {
     Javadoc jd;
 
@@ -84,10 +133,11 @@ buildInfoPair(
     if(RC)
     {
         RC->setAttached();
-        jd = parseJavadoc(RC, D->getASTContext(), D);
+        jd = parseJavadoc(RC, D->getASTContext(), D, cache.Javadocs);
     }
 
-    return buildInfo(D, std::move(jd), std::forward<Args>(args)...);
+    return buildInfo(D, std::move(jd), LineNumber, File,
+        IsFileInRootDir, PublicOnly, cache, R);
 }
 
 // Function to hash a given USR value for storage.
@@ -97,8 +147,6 @@ buildInfoPair(
 // memory (vs storing USRs directly).
 SymbolID hashUSR(llvm::StringRef USR);
 
-std::string serialize(Info const& I);
-
 } // mrdox
 } // clang
 
@@ -0,0 +1,227 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "ast/TUStats.hpp"
+#include "utility.hpp"
+#include <mrdox/Error.hpp>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+
+namespace clang {
+namespace mrdox {
+
+namespace {
+
+llvm::SmallString<0>
+makeKey(
+    llvm::StringRef filePath)
+{
+    llvm::SmallString<0> key(filePath);
+    llvm::sys::path::remove_dots(key, true);
+    convert_to_slash(key);
+    return key;
+}
+
+} // (anon)
+
+llvm::Error
+TUStats::
+load(
+    llvm::StringRef filePath)
+{
+    auto fileText = llvm::MemoryBuffer::getFile(filePath);
+    if(! fileText)
+    {
+        if(fileText.getError() == std::errc::no_such_file_or_directory)
+            return llvm::Error::success();
+        return makeError(fileText.getError().message(),
+            " when loading file '", filePath, "'");
+    }
+    auto json = llvm::json::parse((*fileText)->getBuffer());
+    if(! json)
+        return json.takeError();
+    auto const* entries = json->getAsArray();
+    if(! entries)
+        return makeError("'", filePath, "' is not a JSON array");
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(auto const& value : *entries)
+    {
+        auto const* entry = value.getAsObject();
+        if(! entry)
+            return makeError("'", filePath, "' has a malformed entry");
+        auto file = entry->getString("file");
+        auto seconds = entry->getNumber("seconds");
+        auto size = entry->getInteger("size");
+        auto peak = entry->getInteger("peak");
+        if(! file || ! seconds)
+            return makeError("'", filePath, "' has an entry without \"file\" or \"seconds\"");
+        Entry& e = entries_[makeKey(*file)];
+        e.seconds = *seconds;
+        e.size = size ? static_cast<std::uint64_t>(*size) : 0;
+        e.peak = peak ? static_cast<std::uint64_t>(*peak) : 0;
+    }
+    return llvm::Error::success();
+}
+
+llvm::Error
+TUStats::
+save(
+    llvm::StringRef filePath)
+{
+    namespace fs = llvm::sys::fs;
+
+    std::vector<std::pair<llvm::StringRef, Entry>> sorted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sorted.reserve(entries_.size());
+        for(auto const& e : entries_)
+            sorted.emplace_back(e.getKey(), e.getValue());
+    }
+    std::sort(sorted.begin(), sorted.end(),
+        [](auto const& p0, auto const& p1)
+        {
+            return p0.first < p1.first;
+        });
+
+    // Write a temporary file and rename it, so that
+    // an interrupted run leaves the old file intact.
+    std::string const tempPath = filePath.str() + ".tmp";
+    {
+        std::error_code ec;
+        llvm::raw_fd_ostream os(tempPath, ec, fs::OF_None);
+        if(ec)
+            return makeError("open the file '", tempPath, "' returned ", ec.message());
+        llvm::json::OStream J(os, 1);
+        J.array([&]
+        {
+            for(auto const& [file, e] : sorted)
+            {
+                J.object([&]
+                {
+                    J.attribute("file", file);
+                    J.attribute("seconds", e.seconds);
+                    J.attribute("size", static_cast<int64_t>(e.size));
+                    if(e.peak != 0)
+                        J.attribute("peak", static_cast<int64_t>(e.peak));
+                });
+            }
+        });
+        os << "\n";
+        os.close();
+        if(os.has_error())
+            return makeError("write the file '", tempPath, "' returned ",
+                os.error().message());
+    }
+    if(auto ec = fs::rename(tempPath, filePath))
+        return makeError("rename '", tempPath, "' to '", filePath,
+            "' returned ", ec.message());
+    return llvm::Error::success();
+}
+
+void
+TUStats::
+record(
+    llvm::StringRef filePath,
+    double seconds)
+{
+    std::uint64_t size = 0;
+    if(llvm::sys::fs::file_size(filePath, size))
+        size = 0;
+
+    auto const key = makeKey(filePath);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& e = entries_[key];
+    e.seconds = seconds;
+    e.size = size;
+}
+
+void
+TUStats::
+recordPeak(
+    llvm::StringRef filePath,
+    std::uint64_t bytes)
+{
+    auto const key = makeKey(filePath);
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[key].peak = bytes;
+}
+
+std::uint64_t
+TUStats::
+peak(
+    llvm::StringRef filePath)
+{
+    auto const key = makeKey(filePath);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if(it == entries_.end())
+        return 0;
+    return it->second.peak;
+}
+
+std::size_t
+TUStats::
+order(
+    std::vector<std::string>& files)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Average time per byte of the known files.
+    double knownSeconds = 0;
+    double knownBytes = 0;
+    for(auto const& e : entries_)
+    {
+        if(e.getValue().size == 0)
+            continue;
+        knownSeconds += e.getValue().seconds;
+        knownBytes += static_cast<double>(e.getValue().size);
+    }
+    double const secondsPerByte = knownBytes > 0 ?
+        knownSeconds / knownBytes : 1;
+
+    std::size_t recorded = 0;
+    std::vector<std::pair<double, std::string>> costs;
+    costs.reserve(files.size());
+    for(auto& file : files)
+    {
+        double cost;
+        auto it = entries_.find(makeKey(file));
+        if(it != entries_.end())
+        {
+            cost = it->second.seconds;
+            ++recorded;
+        }
+        else
+        {
+            std::uint64_t size = 0;
+            if(llvm::sys::fs::file_size(file, size))
+                size = 0;
+            cost = secondsPerByte * static_cast<double>(size);
+        }
+        costs.emplace_back(cost, std::move(file));
+    }
+    std::stable_sort(costs.begin(), costs.end(),
+        [](auto const& p0, auto const& p1)
+        {
+            return p0.first > p1.first;
+        });
+    for(std::size_t i = 0; i < costs.size(); ++i)
+        files[i] = std::move(costs[i].second);
+    return recorded;
+}
+
+} // mrdox
+} // clang
@@ -0,0 +1,120 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_AST_TUSTATS_HPP
+#define MRDOX_SOURCE_AST_TUSTATS_HPP
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace mrdox {
+
+/** The time and memory taken to map each translation unit, across runs.
+
+    The statistics are kept in a small JSON file,
+    an array of objects each with a "file", a
+    "seconds", a "size" and a "peak" member. The
+    times are used to start the slowest translation
+    units first, so that a slow one does not start
+    last and leave the run with a long single
+    threaded tail. The peaks are used by the
+    @ref MemoryBudget to admit translation units.
+
+    Files are keyed by their posix style path,
+    with dot components removed.
+
+    @par Thread Safety
+    @ref record, @ref recordPeak and @ref peak
+    may be called concurrently.
+*/
+class TUStats
+{
+    struct Entry
+    {
+        double seconds = 0;
+        std::uint64_t size = 0;
+        std::uint64_t peak = 0;
+    };
+
+    std::mutex mutex_;
+    llvm::StringMap<Entry> entries_;
+
+public:
+    /** Load the statistics from a file.
+
+        A file which does not exist is not an error.
+    */
+    llvm::Error
+    load(
+        llvm::StringRef filePath);
+
+    /** Replace the file with the current statistics.
+
+        The statistics of translation units which
+        were not mapped in this run are kept.
+    */
+    llvm::Error
+    save(
+        llvm::StringRef filePath);
+
+    /** Record the time taken to map a translation unit.
+
+        @param filePath The path of the main file,
+        as it appears in the compilation database.
+
+        @param seconds The time to parse and map it.
+    */
+    void
+    record(
+        llvm::StringRef filePath,
+        double seconds);
+
+    /** Record the peak memory used to map a translation unit.
+
+        @param filePath The path of the main file.
+
+        @param bytes The memory used by the
+        translation unit.
+    */
+    void
+    recordPeak(
+        llvm::StringRef filePath,
+        std::uint64_t bytes);
+
+    /** Return the peak memory recorded for a translation unit, or zero.
+    */
+    std::uint64_t
+    peak(
+        llvm::StringRef filePath);
+
+    /** Sort files by decreasing estimated cost.
+
+        The cost of a file without statistics is
+        estimated from its size, using the average
+        time per byte of the files which have them.
+
+        @return The number of files which have
+        a recorded time.
+    */
+    std::size_t
+    order(
+        std::vector<std::string>& files);
+};
+
+} // mrdox
+} // clang
+
+#endif
@@ -0,0 +1,232 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "ast/UmbrellaDatabase.hpp"
+#include "utility.hpp"
+#include <mrdox/Error.hpp>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/GlobPattern.h>
+#include <llvm/Support/Path.h>
+#include <algorithm>
+#include <map>
+
+namespace clang {
+namespace mrdox {
+
+namespace {
+
+/*  A set of headers which share a command line.
+*/
+struct Group
+{
+    std::string directory;
+    std::vector<std::string> args;
+    std::vector<std::string> headers;
+};
+
+/*  Return the command line without the input file and output options.
+*/
+std::vector<std::string>
+flagsOf(
+    tooling::CompileCommand const& cmd)
+{
+    std::vector<std::string> args;
+    auto const& cl = cmd.CommandLine;
+    for(std::size_t i = 0; i < cl.size(); ++i)
+    {
+        llvm::StringRef arg = cl[i];
+        if(arg == cmd.Filename || arg == "-c" || arg == "--")
+            continue;
+        if(arg == "-o" || arg == "-x")
+        {
+            // skip the value as well
+            ++i;
+            continue;
+        }
+        if(arg.startswith("-o") || arg.startswith("-x"))
+            continue;
+        args.emplace_back(arg);
+    }
+    return args;
+}
+
+/*  Return the posix-style full paths of the matching public headers.
+*/
+llvm::Expected<std::vector<std::string>>
+findHeaders(
+    llvm::StringRef rootDir,
+    std::vector<std::string> const& globs)
+{
+    namespace fs = llvm::sys::fs;
+
+    std::vector<llvm::GlobPattern> patterns;
+    patterns.reserve(globs.size());
+    for(auto const& glob : globs)
+    {
+        auto pattern = llvm::GlobPattern::create(glob);
+        if(! pattern)
+            return pattern.takeError();
+        patterns.emplace_back(std::move(*pattern));
+    }
+
+    std::vector<std::string> headers;
+    std::error_code ec;
+    fs::recursive_directory_iterator it(rootDir, ec);
+    fs::recursive_directory_iterator const end{};
+    for(; it != end && ! ec; it.increment(ec))
+    {
+        if(it->type() != fs::file_type::regular_file)
+            continue;
+        llvm::SmallString<0> filePath(it->path());
+        convert_to_slash(filePath);
+        llvm::StringRef relPath = filePath.str();
+        if(! relPath.consume_front(rootDir))
+            continue;
+        for(auto const& pattern : patterns)
+        {
+            if(pattern.match(relPath))
+            {
+                headers.emplace_back(filePath.str());
+                break;
+            }
+        }
+    }
+    if(ec)
+        return makeError("iterate the directory '", rootDir, "' returned ", ec.message());
+
+    // Make the generated files independent of
+    // the order of directory entries on disk.
+    std::sort(headers.begin(), headers.end());
+    return headers;
+}
+
+} // (anon)
+
+//------------------------------------------------
+
+llvm::Expected<std::unique_ptr<UmbrellaDatabase>>
+UmbrellaDatabase::
+create(
+    tooling::CompilationDatabase const& db,
+    Config const& config,
+    Reporter& R)
+{
+    namespace path = llvm::sys::path;
+
+    llvm::StringRef rootDir = config.sourceRoot();
+    if(rootDir.empty())
+        rootDir = config.configDir();
+
+    auto headers = findHeaders(rootDir, config.publicHeaders());
+    if(! headers)
+        return headers.takeError();
+    if(headers->empty())
+        return makeError("no files in '", rootDir, "' match the public headers");
+
+    // Headers without a command of their own are
+    // parsed with the first command of the database.
+    std::vector<tooling::CompileCommand> fallback =
+        db.getAllCompileCommands();
+    if(fallback.empty())
+        return makeError("the compilation database is empty");
+
+    // Group the headers by command line. Databases loaded
+    // from compile_commands.json interpolate a command for
+    // each header from the closest translation unit.
+    std::map<std::string, Group> groups;
+    for(auto const& header : *headers)
+    {
+        auto cmds = db.getCompileCommands(header);
+        tooling::CompileCommand const& cmd =
+            cmds.empty() ? fallback.front() : cmds.front();
+        auto args = flagsOf(cmd);
+        std::string key = cmd.Directory;
+        for(auto const& arg : args)
+        {
+            key.push_back('\0');
+            key.append(arg);
+        }
+        auto result = groups.try_emplace(std::move(key));
+        Group& group = result.first->second;
+        if(result.second)
+        {
+            group.directory = cmd.Directory;
+            group.args = std::move(args);
+        }
+        group.headers.emplace_back(header);
+    }
+
+    if(config.verbose())
+        R.print("Including ", headers->size(), " public headers in ",
+            groups.size(), " translation units");
+
+    std::unique_ptr<UmbrellaDatabase> result(new UmbrellaDatabase);
+    for(auto& [key, group] : groups)
+    {
+        File file;
+        llvm::SmallString<0> filePath(rootDir);
+        path::append(filePath, path::Style::posix,
+            "mrdox-umbrella-" + std::to_string(result->files_.size()) + ".cpp");
+        file.path = filePath.str();
+        file.content = "// Generated by mrdox, do not edit.\n";
+        for(auto const& header : group.headers)
+        {
+            file.content.append("#include \"");
+            file.content.append(header);
+            file.content.append("\"\n");
+            std::uint64_t size = 0;
+            if(! llvm::sys::fs::file_size(header, size))
+                file.inputSize += size;
+        }
+        file.inputSize += file.content.size();
+
+        group.args.emplace_back(file.path);
+        result->cc_.emplace_back(
+            group.directory,
+            file.path,
+            std::move(group.args),
+            "");
+        result->cc_.back().Heuristic = "umbrella header";
+        result->files_.emplace_back(std::move(file));
+    }
+    return result;
+}
+
+std::vector<tooling::CompileCommand>
+UmbrellaDatabase::
+getCompileCommands(
+    llvm::StringRef FilePath) const
+{
+    for(auto const& cc : cc_)
+        if(FilePath == cc.Filename)
+            return { cc };
+    return {};
+}
+
+std::vector<std::string>
+UmbrellaDatabase::
+getAllFiles() const
+{
+    std::vector<std::string> result;
+    result.reserve(cc_.size());
+    for(auto const& cc : cc_)
+        result.emplace_back(cc.Filename);
+    return result;
+}
+
+std::vector<tooling::CompileCommand>
+UmbrellaDatabase::
+getAllCompileCommands() const
+{
+    return cc_;
+}
+
+} // mrdox
+} // clang
@@ -0,0 +1,92 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_AST_UMBRELLADATABASE_HPP
+#define MRDOX_SOURCE_AST_UMBRELLADATABASE_HPP
+
+#include <mrdox/Config.hpp>
+#include <mrdox/Reporter.hpp>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <llvm/Support/Error.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace mrdox {
+
+/** Compilation database of synthetic umbrella translation units.
+
+    Each translation unit includes a group of public
+    headers matched by @ref Config::publicHeaders.
+    Headers are grouped by the compile command which
+    the underlying database produces for them, so that
+    each header is parsed with the flags it would have
+    in the project's own build.
+
+    The synthetic files do not exist on disk. Their
+    contents must be mapped into the file system of
+    each tool invocation, using @ref files.
+*/
+class UmbrellaDatabase
+    : public tooling::CompilationDatabase
+{
+public:
+    struct File
+    {
+        std::string path;
+        std::string content;
+
+        /** The size of the content and of the headers it includes.
+        */
+        std::uint64_t inputSize = 0;
+    };
+
+    /** Return a database with the umbrella translation units.
+
+        @param db The compilation database of the project.
+
+        @param config The configuration.
+    */
+    static
+    llvm::Expected<std::unique_ptr<UmbrellaDatabase>>
+    create(
+        tooling::CompilationDatabase const& db,
+        Config const& config,
+        Reporter& R);
+
+    /** Return the contents of the synthetic files.
+    */
+    std::vector<File> const&
+    files() const noexcept
+    {
+        return files_;
+    }
+
+    std::vector<tooling::CompileCommand>
+    getCompileCommands(
+        llvm::StringRef FilePath) const override;
+
+    std::vector<std::string>
+    getAllFiles() const override;
+
+    std::vector<tooling::CompileCommand>
+    getAllCompileCommands() const override;
+
+private:
+    std::vector<tooling::CompileCommand> cc_;
+    std::vector<File> files_;
+};
+
+} // mrdox
+} // clang
+
+#endif
@@ -10,9 +10,16 @@
 //
 
 #include "Asciidoc.hpp"
+#include "CharScanner.hpp"
+#include "OutputFiles.hpp"
+#include "SearchIndex.hpp"
+#include "Scheduler.hpp"
 #include <mrdox/Metadata.hpp>
 #include <mrdox/format/OverloadSet.hpp>
 #include <clang/Basic/Specifiers.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/xxhash.h>
+#include <atomic>
 
 namespace clang {
 namespace mrdox {
@@ -27,93 +34,241 @@ bool
 AsciidocGenerator::
 build(
     llvm::StringRef rootPath,
-    Corpus& corpus,
+    Corpus const& corpus,
     Config const& config,
     Reporter& R) const
 {
+    namespace fs = llvm::sys::fs;
     namespace path = llvm::sys::path;
 
-#if 0
-    // Track which directories we already tried to create.
-    llvm::StringSet<> CreatedDirs;
+    if(config.multiPage())
+        return buildPages(rootPath, corpus, config, R);
+
+    if(R.error(fs::create_directories(rootPath),
+            "create directories in '", rootPath, "'"))
+        return false;
+    llvm::SmallString<0> fileName(rootPath);
+    path::append(fileName, "reference.adoc");
+    return buildOne(fileName, corpus, config, R);
+}
 
-    // Collect all output by file name and create the necessary directories.
-    llvm::StringMap<std::vector<mrdox::Info*>> FileToInfos;
-    for (const auto& Group : corpus.InfoMap)
+namespace {
+
+/** Return a name which is safe to use as a file name.
+
+    Characters other than letters, digits and the
+    underscore are written as a dash followed by
+    two hex digits. An empty name becomes a dash,
+    and an overload set named "index", in any case,
+    gets a trailing dash, since that name is taken
+    by the page of its scope. Names which are still
+    the same, such as those of unnamed records, are
+    told apart by the @ref LinkTable.
+*/
+std::string
+safeName(
+    llvm::StringRef name)
+{
+    static constexpr char hex[] = "0123456789ABCDEF";
+    std::string result;
+    result.reserve(name.size());
+    for(unsigned char c : name)
     {
-        mrdox::Info* Info = Group.getValue().get();
-
-        llvm::SmallString<128> Path;
-        llvm::sys::path::native(RootDir, Path);
-        llvm::sys::path::append(Path, Info->getRelativeFilePath(""));
-        if (!CreatedDirs.contains(Path)) {
-            if (std::error_code Err = llvm::sys::fs::create_directories(Path);
-                Err != std::error_code()) {
-                return llvm::createStringError(Err, "Failed to create directory '%s'.",
-                    Path.c_str());
-            }
-            CreatedDirs.insert(Path);
+        if(llvm::isAlnum(c) || c == '_')
+        {
+            result.push_back(static_cast<char>(c));
+            continue;
         }
+        result.push_back('-');
+        result.push_back(hex[c >> 4]);
+        result.push_back(hex[c & 15]);
+    }
+    if( result.empty() ||
+        llvm::StringRef(result).equals_insensitive("index"))
+        result.push_back('-');
+    return result;
+}
+
+// Changing how pages are rendered must change
+// this, so that no page of an older version is
+// kept because its symbols are the same.
+constexpr std::uint64_t pageVersion = 1;
+
+std::uint64_t
+pageHash(
+    llvm::ArrayRef<std::uint64_t> v)
+{
+    return llvm::xxHash64(llvm::StringRef(
+        reinterpret_cast<char const*>(v.data()),
+        v.size() * sizeof(std::uint64_t)));
+}
 
-        llvm::sys::path::append(Path, Info->getFileBaseName() + ".adoc");
-        FileToInfos[Path].push_back(Info);
+void
+collectPages(
+    Corpus const& corpus,
+    LinkTable const& links,
+    Info const& I,
+    Scope const& scope,
+    std::vector<AsciidocGenerator::Page>& pages)
+{
+    pages.push_back({ &I, llvm::None, links.page(I.USR).str(),
+        pageHash({ pageVersion, corpus.hash(I.USR) }) });
+    for(auto const& ref : scope.Namespaces)
+    {
+        auto const& J = corpus.get<NamespaceInfo>(ref.USR);
+        collectPages(corpus, links, J, J.Children, pages);
+    }
+    for(auto const& ref : scope.Records)
+    {
+        auto const& J = corpus.get<RecordInfo>(ref.USR);
+        collectPages(corpus, links, J, J.Children, pages);
+    }
+    for(auto const& set : corpus.overloads(I.USR).all())
+    {
+        llvm::SmallVector<std::uint64_t, 8> v;
+        v.push_back(pageVersion);
+        for(auto const* J : set.list)
+            v.push_back(corpus.hash(J->USR));
+        std::uint64_t const hash = pageHash(v);
+        pages.push_back({ &I, set,
+            links.page(set.list.front()->USR).str(), hash });
     }
+}
 
-    for (const auto& Group : FileToInfos) {
-        std::error_code FileErr;
-        llvm::raw_fd_ostream InfoOS(Group.getKey(), FileErr,
-            llvm::sys::fs::OF_None);
-        if (FileErr) {
-            return llvm::createStringError(FileErr, "Error opening file '%s'",
-                Group.getKey().str().c_str());
-        }
+/** Return the table of pages for multi-page output.
 
-        for (const auto& Info : Group.getValue()) {
-            if (llvm::Error Err = generateDocForInfo(Info, InfoOS, config)) {
-                return Err;
-            }
-        }
+    A namespace or record is written to `index.adoc`
+    in a directory of its own, and an overload set
+    is written next to the page of its scope.
+*/
+LinkTable
+makeLinks(
+    Corpus const& corpus)
+{
+    return LinkTable::build(corpus,
+        [](Info const& I)
+        {
+            return safeName(I.extractName());
+        },
+        [](Info const& I) -> LinkTable::Location
+        {
+            if(I.IT == InfoType::IT_function)
+                return { safeName(I.Name) + ".adoc", {} };
+            return { "index.adoc", {} };
+        });
+}
+
+} // (anon)
+
+bool
+AsciidocGenerator::
+buildPages(
+    llvm::StringRef rootPath,
+    Corpus const& corpus,
+    Config const& config,
+    Reporter& R) const
+{
+    namespace fs = llvm::sys::fs;
+    namespace path = llvm::sys::path;
+
+    // The pages are listed in one pass, in the
+    // canonical order of the corpus, so that the
+    // work does not depend on the scheduling.
+    LinkTable const links = makeLinks(corpus);
+    std::vector<Page> pages;
+    auto const& global = corpus.globalNamespace();
+    collectPages(corpus, links, global, global.Children, pages);
+
+    // Every directory is created up front, once,
+    // instead of by each page as it is written.
+    for(auto const& page : pages)
+    {
+        if(page.overloads)
+            continue;
+        llvm::SmallString<0> dir(rootPath);
+        path::append(dir, path::Style::posix,
+            path::parent_path(page.fileName, path::Style::posix));
+        path::native(dir);
+        if(R.error(fs::create_directories(dir),
+                "create the directory '", dir, "'"))
+            return false;
     }
+
+    OutputFiles files(rootPath);
+    Scheduler& scheduler = corpus.scheduler();
+    std::atomic<std::size_t> next = 0;
+    std::atomic<std::size_t> rendered = 0;
+    std::atomic<bool> failed = false;
+    scheduler.run(Phase::generate,
+        std::min(scheduler.concurrency(Phase::generate), pages.size()),
+        [&](std::size_t)
+        {
+            // Each worker renders its pages with
+            // its own writer into a reused buffer.
+            std::string text;
+            llvm::raw_string_ostream os(text);
+            Writer w(os, corpus, config, R);
+            for(;;)
+            {
+                std::size_t const i = next++;
+                if(i >= pages.size())
+                    return;
+                if(files.keep(pages[i].fileName, pages[i].hash))
+                    continue;
+                ++rendered;
+                text.clear();
+                w.writePage(pages[i], links);
+                if(R.error(files.write(pages[i].fileName, text, pages[i].hash),
+                        "write the page '", pages[i].fileName, "'"))
+                    failed = true;
+            }
+        });
+    if(failed)
+        return false;
+
+    // The search index and its loader are
+    // written next to the index of the pages.
+    std::string searchIndex;
+    buildSearchIndex(searchIndex, corpus, links);
+    if(R.error(files.write("search-index.txt", searchIndex),
+            "write the search index"))
+        return false;
+    if(R.error(files.write("search.js", searchIndexLoader()),
+            "write the search script"))
+        return false;
+
+    // Pages of symbols which are gone are removed
+    auto written = files.finish();
+    if(R.error(written, "finish the output in '", rootPath, "'"))
+        return false;
+    if(config.verbose())
+        R.print("Rendered ", rendered.load(), " and wrote ",
+            *written, " of ", pages.size(), " pages");
     return true;
-#else
-    llvm::SmallString<0> fileName(rootPath);
-    path::append(fileName, "reference.adoc");
-    return buildOne(fileName, corpus, config, R);
-#endif
 }
 
 bool
 AsciidocGenerator::
 buildOne(
     llvm::StringRef fileName,
-    Corpus& corpus,
+    Corpus const& corpus,
     Config const& config,
     Reporter& R) const
 {
-    namespace fs = llvm::sys::fs;
-
-    std::error_code ec;
-    llvm::raw_fd_ostream os(
-        fileName,
-        ec,
-        fs::CD_CreateAlways,
-        fs::FA_Write,
-        fs::OF_None);
-    if(R.error(ec, "open the stream for '", fileName, "'"))
+    std::string text;
+    if(! buildString(text, corpus, config, R))
         return false;
-
-    Writer w(os, corpus, config, R);
-    w.beginFile();
-    w.visitAllSymbols();
-    w.endFile();
-    return ! os.has_error();
+    auto changed = writeIfChanged(fileName, text);
+    if(R.error(changed, "write the file '", fileName, "'"))
+        return false;
+    return true;
 }
 
 bool
 AsciidocGenerator::
 buildString(
     std::string& dest,
-    Corpus& corpus,
+    Corpus const& corpus,
     Config const& config,
     Reporter& R) const
 {
@@ -198,6 +353,54 @@ endFile()
     closeSection();
 }
 
+void
+AsciidocGenerator::
+Writer::
+writePage(
+    Page const& page,
+    LinkTable const& links)
+{
+    std::string temp;
+    llvm::StringRef title = "Reference";
+    if(page.I->USR != EmptySID)
+    {
+        title = page.I->getFullyQualifiedName(temp);
+        if(page.overloads)
+        {
+            temp.append("::");
+            temp.append(page.overloads->name.data(), page.overloads->name.size());
+            title = temp;
+        }
+    }
+    else if(page.overloads)
+    {
+        title = page.overloads->name;
+    }
+
+    links_ = &links;
+    page_ = page.fileName;
+    openTitle(title);
+    os_ <<
+        ":role: mrdox\n";
+    if(page.overloads)
+    {
+        for(auto const* I : page.overloads->list)
+            writeFunction(*I);
+    }
+    else if(page.I->IT == InfoType::IT_namespace)
+    {
+        writeNamespacePage(*static_cast<NamespaceInfo const*>(page.I));
+    }
+    else
+    {
+        auto const& I = *static_cast<RecordInfo const*>(page.I);
+        writeRecord(I);
+        writeScopeIndex("Member Types", I.Children.Records);
+    }
+    closeSection();
+    links_ = nullptr;
+}
+
 //------------------------------------------------
 
 void
@@ -270,11 +473,7 @@ writeRecord(
 
     writeOverloadSet(
         "Member Functions",
-        makeOverloadSet(corpus_, I.Children,
-            [](FunctionInfo const& I)
-            {
-                return I.Access == AccessSpecifier::AS_public;
-            }));
+        corpus_.overloads(I.USR).get(AccessSpecifier::AS_public));
 
     writeMemberTypes(
         "Protected Data Members",
@@ -283,11 +482,7 @@ writeRecord(
 
     writeOverloadSet(
         "Protected Member Functions",
-        makeOverloadSet(corpus_, I.Children,
-            [](FunctionInfo const& I)
-            {
-                return I.Access == AccessSpecifier::AS_protected;
-            }));
+        corpus_.overloads(I.USR).get(AccessSpecifier::AS_protected));
 
     writeMemberTypes(
         "Private Data Members",
@@ -296,11 +491,7 @@ writeRecord(
 
     writeOverloadSet(
         "Private Member Functions",
-        makeOverloadSet(corpus_, I.Children,
-            [](FunctionInfo const& I)
-            {
-                return I.Access == AccessSpecifier::AS_private;
-            }));
+        corpus_.overloads(I.USR).get(AccessSpecifier::AS_private));
 
     closeSection();
 }
@@ -394,6 +585,66 @@ writeTypedef(
 
 //------------------------------------------------
 
+void
+AsciidocGenerator::
+Writer::
+writeNamespacePage(
+    NamespaceInfo const& I)
+{
+    // Brief
+    writeBrief(I.javadoc.getBrief());
+
+    // Description
+    writeDescription(I.javadoc.getBlocks());
+
+    writeScopeIndex("Namespaces", I.Children.Namespaces);
+    writeScopeIndex("Types", I.Children.Records);
+    writeOverloadSet(
+        "Functions",
+        corpus_.overloads(I.USR).all());
+
+    for(auto const& J : I.Children.Enums)
+        writeEnum(J);
+    for(auto const& J : I.Children.Typedefs)
+        writeTypedef(J);
+}
+
+void
+AsciidocGenerator::
+Writer::
+writeScopeIndex(
+    llvm::StringRef sectionName,
+    std::vector<Reference> const& list)
+{
+    if(list.empty())
+        return;
+    openSection(sectionName);
+    os_ <<
+        "\n"
+        "[,cols=2]\n" <<
+        "|===\n" <<
+        "|Name |Description\n" <<
+        "\n";
+    llvm::SmallString<64> url;
+    for(auto const& ref : list)
+    {
+        auto const& J = corpus_.get<Info>(ref.USR);
+        url.clear();
+        links_->link(url, page_, J.USR);
+        os_ <<
+            "|xref:" << url << "[`" << J.Name << "`]\n" <<
+            "|";
+        writeBrief(J.javadoc.getBrief());
+        os_ << "\n";
+    }
+    os_ <<
+        "|===\n" <<
+        "\n";
+    closeSection();
+}
+
+//------------------------------------------------
+
 void
 AsciidocGenerator::
 Writer::
@@ -418,7 +669,7 @@ AsciidocGenerator::
 Writer::
 writeOverloadSet(
     llvm::StringRef sectionName,
-    std::vector<OverloadSet> const& list)
+    llvm::ArrayRef<OverloadSet> list)
 {
     if(list.empty())
         return;
@@ -429,11 +680,20 @@ writeOverloadSet(
         "|===\n" <<
         "|Name |Description\n" <<
         "\n";
+    llvm::SmallString<64> url;
     for(auto const& J : list)
     {
-        os_ <<
-            "|`" << J.name << "`\n" <<
-            "|";
+        // In multi-page output, the overload
+        // set has a page of its own.
+        url.clear();
+        if(links_ && links_->link(url, page_, J.list.front()->USR))
+            os_ <<
+                "|xref:" << url << "[`" << J.name << "`]\n" <<
+                "|";
+        else
+            os_ <<
+                "|`" << J.name << "`\n" <<
+                "|";
         for(auto const& K : J.list)
             writeBrief(K->javadoc.getBrief());
     }   
@@ -593,13 +853,39 @@ writeNode(
     }
 }
 
+namespace asciidoc {
+
+void
+escape::
+write(
+    llvm::raw_ostream& os) const
+{
+    static CharScanner const scanner(chars);
+
+    std::size_t pos = 0;
+    for(;;)
+    {
+        auto const found = scanner.find(s_, pos);
+        if(found == llvm::StringRef::npos)
+        {
+            os.write(s_.data() + pos, s_.size() - pos);
+            break;
+        }
+        os.write(s_.data() + pos, found - pos);
+        os << "&#" << static_cast<unsigned>(s_[found]) << ';';
+        pos = found + 1;
+    }
+}
+
+} // asciidoc
+
 void
 AsciidocGenerator::
 Writer::
 writeNode(
     Javadoc::Text const& node)
 {
-    os_ << node.string << '\n';
+    os_ << asciidoc::escape(node.string) << '\n';
 }
 
 void
@@ -611,16 +897,16 @@ writeNode(
     switch(node.style)
     {
     case Javadoc::Style::bold:
-        os_ << '*' << node.string << "*\n";
+        os_ << '*' << asciidoc::escape(node.string) << "*\n";
         break;
     case Javadoc::Style::mono:
-        os_ << '`' << node.string << "`\n";
+        os_ << '`' << asciidoc::escape(node.string) << "`\n";
         break;
     case Javadoc::Style::italic:
-        os_ << '_' << node.string << "_\n";
+        os_ << '_' << asciidoc::escape(node.string) << "_\n";
         break;
     default:
-        os_ << node.string << '\n';
+        os_ << asciidoc::escape(node.string) << '\n';
         break;
     }
 }
@@ -652,7 +938,9 @@ writeNode(
     os_ <<
         "[,cpp]\n"
         "----\n";
-    writeNodes(node.children);
+    // Listing blocks are verbatim
+    for(Javadoc::Text const& text : node.children)
+        os_ << text.string << '\n';
     os_ <<
         "----\n";
 }
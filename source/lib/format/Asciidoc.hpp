@@ -12,27 +12,71 @@
 #ifndef MRDOX_SOURCE_ASCIIDOC_HPP
 #define MRDOX_SOURCE_ASCIIDOC_HPP
 
+#include "LinkTable.hpp"
 #include <mrdox/Config.hpp>
 #include <mrdox/Corpus.hpp>
 #include <mrdox/MetadataFwd.hpp>
 #include <mrdox/format/FlatWriter.hpp>
 #include <mrdox/format/Generator.hpp>
+#include <mrdox/format/OverloadSet.hpp>
+#include <llvm/ADT/Optional.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Path.h>
 #include <llvm/Support/raw_ostream.h>
+#include <cstdint>
 #include <string>
 
 namespace clang {
 namespace mrdox {
 
-struct OverloadSet;
+namespace asciidoc {
+
+/** Manipulator to apply Asciidoc escaping to output.
+
+    Characters which start inline formatting,
+    passthroughs, attribute references or macros
+    are written as numeric character references.
+*/
+struct escape
+{
+    /** The characters which are escaped.
+    */
+    static constexpr llvm::StringRef chars = "*_`#^~+{[";
+
+    explicit
+    escape(
+        llvm::StringRef const& s) noexcept
+        : s_(s)
+    {
+    }
+
+    friend
+    llvm::raw_ostream&
+    operator<<(
+        llvm::raw_ostream& os,
+        escape const& t)
+    {
+        t.write(os);
+        return os;
+    }
+
+private:
+    void write(llvm::raw_ostream& os) const;
+
+    llvm::StringRef s_;
+};
+
+} // asciidoc
+
+//------------------------------------------------
 
 class AsciidocGenerator
     : public Generator
 {
 public:
     class Writer;
+    struct Page;
 
     llvm::StringRef
     name() const noexcept override
@@ -49,23 +93,67 @@ public:
     bool
     build(
         llvm::StringRef rootPath,
-        Corpus& corpus,
+        Corpus const& corpus,
         Config const& config,
         Reporter& R) const override;
 
     bool
     buildOne(
         llvm::StringRef fileName,
-        Corpus& corpus,
+        Corpus const& corpus,
         Config const& config,
         Reporter& R) const override;
 
     bool
     buildString(
         std::string& dest,
-        Corpus& corpus,
+        Corpus const& corpus,
         Config const& config,
         Reporter& R) const override;
+
+    /** Build one page per namespace, record and overload set.
+
+        The pages are rendered concurrently, and
+        each page only depends on the corpus, so the
+        output does not depend on the number of threads.
+
+        @param rootPath The directory which
+        will hold the pages.
+    */
+    bool
+    buildPages(
+        llvm::StringRef rootPath,
+        Corpus const& corpus,
+        Config const& config,
+        Reporter& R) const;
+};
+
+//------------------------------------------------
+
+/** A page of multi-page output.
+
+    A namespace or record is written to `index.adoc`
+    in a directory of its own, nested in the directory
+    of its parent. An overload set is written next to
+    the page of its scope.
+*/
+struct AsciidocGenerator::Page
+{
+    /** The namespace or record of the page, or the scope of the overload set.
+    */
+    Info const* I;
+
+    /** The functions of the page, if it is for an overload set.
+    */
+    llvm::Optional<OverloadSet> overloads;
+
+    /** The posix-style path of the page, relative to the output directory.
+    */
+    std::string fileName;
+
+    /** The hash of the symbols rendered on the page.
+    */
+    std::uint64_t hash;
 };
 
 //------------------------------------------------
@@ -80,6 +168,8 @@ class AsciidocGenerator::Writer
     };
 
     Section sect_;
+    LinkTable const* links_ = nullptr;
+    llvm::StringRef page_;
 
 public:
     Writer(
@@ -91,6 +181,18 @@ public:
     void beginFile() override;
     void endFile() override;
 
+    /** Write a complete page of multi-page output.
+
+        The writer may be reused for another
+        page afterwards.
+
+        @param page The page to write.
+
+        @param links The pages of every symbol,
+        used to link to other pages.
+    */
+    void writePage(Page const& page, LinkTable const& links);
+
     struct FormalParam;
     struct TypeName;
 
@@ -103,11 +205,16 @@ protected:
     void writeEnum(EnumInfo const& I) override;
     void writeTypedef(TypedefInfo const& I) override;
 
+    void writeNamespacePage(NamespaceInfo const& I);
+    void writeScopeIndex(
+        llvm::StringRef sectionName,
+        std::vector<Reference> const& list);
+
     void writeLocation(Location const&);
     void writeBase(BaseRecordInfo const& I);
     void writeOverloadSet(
         llvm::StringRef sectionName,
-        std::vector<OverloadSet> const& list);
+        llvm::ArrayRef<OverloadSet> list);
     void writeMemberTypes(
         llvm::StringRef sectionName,
         llvm::SmallVectorImpl<MemberTypeInfo> const& list,
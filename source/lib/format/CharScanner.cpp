@@ -0,0 +1,235 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "CharScanner.hpp"
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/MathExtras.h>
+#include <cassert>
+#include <cstring>
+
+// SSE2 is part of every x86-64 CPU, while AVX2
+// is only used after checking for it at runtime.
+#if defined(__x86_64__) || defined(_M_X64)
+#define MRDOX_CHARSCANNER_X86
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define MRDOX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MRDOX_TARGET_AVX2
+#endif
+#endif
+
+namespace clang {
+namespace mrdox {
+
+CharScanner::
+CharScanner(
+    llvm::StringRef chars,
+    Kind kind) noexcept
+    : size_(chars.size())
+    , kind_(isSupported(kind) ? kind : Kind::scalar)
+{
+    assert(chars.size() <= maxChars);
+    assert(isSupported(kind));
+    if(size_ > maxChars)
+        size_ = maxChars;
+    std::memcpy(chars_, chars.data(), size_);
+    std::memset(table_, 0, sizeof(table_));
+    for(std::size_t i = 0; i < size_; ++i)
+        table_[static_cast<unsigned char>(chars_[i])] = true;
+}
+
+auto
+CharScanner::
+best() noexcept ->
+    Kind
+{
+    static Kind const kind = []
+    {
+#ifdef MRDOX_CHARSCANNER_X86
+        llvm::StringMap<bool> features;
+        if( llvm::sys::getHostCPUFeatures(features) &&
+            features.lookup("avx2"))
+            return Kind::avx2;
+        return Kind::sse2;
+#else
+        return Kind::scalar;
+#endif
+    }();
+    return kind;
+}
+
+bool
+CharScanner::
+isSupported(
+    Kind kind) noexcept
+{
+    switch(kind)
+    {
+    case Kind::scalar:
+        return true;
+    case Kind::sse2:
+#ifdef MRDOX_CHARSCANNER_X86
+        return true;
+#else
+        return false;
+#endif
+    case Kind::avx2:
+        return best() == Kind::avx2;
+    default:
+        return false;
+    }
+}
+
+llvm::StringRef
+CharScanner::
+name(
+    Kind kind) noexcept
+{
+    switch(kind)
+    {
+    case Kind::scalar: return "scalar";
+    case Kind::sse2:   return "sse2";
+    case Kind::avx2:   return "avx2";
+    default:
+        llvm_unreachable("unknown Kind");
+    }
+}
+
+std::size_t
+CharScanner::
+find(
+    llvm::StringRef s,
+    std::size_t pos) const noexcept
+{
+    if(pos >= s.size() || size_ == 0)
+        return llvm::StringRef::npos;
+    char const* const p = s.data() + pos;
+    char const* const end = s.data() + s.size();
+    std::size_t n;
+    switch(kind_)
+    {
+    case Kind::sse2:
+        n = findSSE2(p, end);
+        break;
+    case Kind::avx2:
+        n = findAVX2(p, end);
+        break;
+    default:
+        n = findScalar(p, end);
+        break;
+    }
+    if(n == llvm::StringRef::npos)
+        return n;
+    return pos + n;
+}
+
+//------------------------------------------------
+
+std::size_t
+CharScanner::
+findScalar(
+    char const* p,
+    char const* end) const noexcept
+{
+    for(char const* it = p; it != end; ++it)
+        if(table_[static_cast<unsigned char>(*it)])
+            return it - p;
+    return llvm::StringRef::npos;
+}
+
+#ifdef MRDOX_CHARSCANNER_X86
+
+std::size_t
+CharScanner::
+findSSE2(
+    char const* p,
+    char const* end) const noexcept
+{
+    __m128i set[maxChars];
+    for(std::size_t i = 0; i < size_; ++i)
+        set[i] = _mm_set1_epi8(chars_[i]);
+
+    char const* it = p;
+    while(end - it >= 16)
+    {
+        __m128i const v = _mm_loadu_si128(
+            reinterpret_cast<__m128i const*>(it));
+        __m128i m = _mm_cmpeq_epi8(v, set[0]);
+        for(std::size_t i = 1; i < size_; ++i)
+            m = _mm_or_si128(m, _mm_cmpeq_epi8(v, set[i]));
+        auto const mask = static_cast<unsigned>(_mm_movemask_epi8(m));
+        if(mask != 0)
+            return (it - p) + llvm::countTrailingZeros(mask);
+        it += 16;
+    }
+    auto const n = findScalar(it, end);
+    if(n == llvm::StringRef::npos)
+        return n;
+    return (it - p) + n;
+}
+
+MRDOX_TARGET_AVX2
+std::size_t
+CharScanner::
+findAVX2(
+    char const* p,
+    char const* end) const noexcept
+{
+    __m256i set[maxChars];
+    for(std::size_t i = 0; i < size_; ++i)
+        set[i] = _mm256_set1_epi8(chars_[i]);
+
+    char const* it = p;
+    while(end - it >= 32)
+    {
+        __m256i const v = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(it));
+        __m256i m = _mm256_cmpeq_epi8(v, set[0]);
+        for(std::size_t i = 1; i < size_; ++i)
+            m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, set[i]));
+        auto const mask = static_cast<unsigned>(_mm256_movemask_epi8(m));
+        if(mask != 0)
+            return (it - p) + llvm::countTrailingZeros(mask);
+        it += 32;
+    }
+    // The tail is shorter than one vector
+    auto const n = findSSE2(it, end);
+    if(n == llvm::StringRef::npos)
+        return n;
+    return (it - p) + n;
+}
+
+#else
+
+std::size_t
+CharScanner::
+findSSE2(
+    char const* p,
+    char const* end) const noexcept
+{
+    return findScalar(p, end);
+}
+
+std::size_t
+CharScanner::
+findAVX2(
+    char const* p,
+    char const* end) const noexcept
+{
+    return findScalar(p, end);
+}
+
+#endif
+
+} // mrdox
+} // clang
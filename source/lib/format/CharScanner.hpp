@@ -0,0 +1,109 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_FORMAT_CHARSCANNER_HPP
+#define MRDOX_SOURCE_FORMAT_CHARSCANNER_HPP
+
+#include <llvm/ADT/StringRef.h>
+#include <cstddef>
+
+namespace clang {
+namespace mrdox {
+
+/** Finds the next occurrence of any of a small set of characters.
+
+    Generators use this to find the characters
+    which must be escaped. Instead of looking at
+    one byte at a time, the text is compared with
+    every character of the set 16 bytes at a time
+    with SSE2, or 32 bytes at a time with AVX2. The
+    widest implementation which the CPU supports
+    is chosen at runtime, and the scalar one is
+    used on other architectures.
+*/
+class CharScanner
+{
+public:
+    /** An implementation of the scanner.
+    */
+    enum class Kind
+    {
+        scalar,
+        sse2,
+        avx2
+    };
+
+    /** The largest number of characters in a set.
+    */
+    static constexpr std::size_t maxChars = 16;
+
+    /** Constructor.
+
+        @param chars The characters to find,
+        at most @ref maxChars of them.
+
+        @param kind The implementation to use,
+        which must be supported.
+    */
+    explicit
+    CharScanner(
+        llvm::StringRef chars,
+        Kind kind = best()) noexcept;
+
+    /** Return the widest implementation which this CPU supports.
+    */
+    static
+    Kind
+    best() noexcept;
+
+    /** Return true if an implementation is supported by this CPU.
+    */
+    static
+    bool
+    isSupported(
+        Kind kind) noexcept;
+
+    /** Return the name of an implementation.
+    */
+    static
+    llvm::StringRef
+    name(
+        Kind kind) noexcept;
+
+    /** Return the position of the first character in the set.
+
+        @return The position, which is at least
+        `pos`, or `llvm::StringRef::npos` if no
+        character of the set was found.
+
+        @param s The string to search.
+
+        @param pos The position to start at.
+    */
+    std::size_t
+    find(
+        llvm::StringRef s,
+        std::size_t pos = 0) const noexcept;
+
+private:
+    char chars_[maxChars];
+    std::size_t size_;
+    Kind kind_;
+    bool table_[256];
+
+    std::size_t findScalar(char const* p, char const* end) const noexcept;
+    std::size_t findSSE2(char const* p, char const* end) const noexcept;
+    std::size_t findAVX2(char const* p, char const* end) const noexcept;
+};
+
+} // mrdox
+} // clang
+
+#endif
@@ -10,9 +10,11 @@
 //
 
 #include "Commands.hpp"
+#include "Scheduler.hpp"
 #include <mrdox/format/Generator.hpp>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Path.h>
+#include <atomic>
 
 namespace clang {
 namespace mrdox {
@@ -21,7 +23,7 @@ bool
 Generator::
 build(
     StringRef outputPath,
-    Corpus& corpus,
+    Corpus const& corpus,
     Config const& config,
     Reporter& R) const
 {
@@ -38,7 +40,8 @@ build(
     std::error_code ec = fs::status(outputPath, status);
     if(ec == std::errc::no_such_file_or_directory)
     {
-        ec = fs::create_directories(outputPath, false);
+        // Another generator may create it first
+        ec = fs::create_directories(outputPath);
         if(R.error(ec, "create directories in '", outputPath, "'"))
             return false;
     }
@@ -60,5 +63,46 @@ build(
     return buildOne(outputPath, corpus, config, R);
 }
 
+//------------------------------------------------
+
+bool
+buildAll(
+    llvm::ArrayRef<Generator const*> generators,
+    llvm::StringRef outputPath,
+    Corpus const& corpus,
+    Config const& config,
+    Reporter& R)
+{
+    // Generators given an existing file would all
+    // write to it, each replacing the output of
+    // the others. A missing directory is created
+    // once here, before they run concurrently.
+    if(generators.size() > 1)
+    {
+        namespace fs = llvm::sys::fs;
+        if(fs::exists(outputPath) && ! fs::is_directory(outputPath))
+        {
+            R.failed("build ", generators.size(), " formats into '",
+                outputPath, "' because it is a file and not a directory");
+            return false;
+        }
+        if(R.error(fs::create_directories(outputPath),
+                "create directories in '", outputPath, "'"))
+            return false;
+    }
+
+    // Each generator renders in parallel on the
+    // same scheduler, so a slow one does not keep
+    // the threads from working on the others.
+    std::atomic<bool> success = true;
+    corpus.scheduler().forEach(Phase::generate, generators.size(),
+        [&](std::size_t i)
+        {
+            if(! generators[i]->build(outputPath, corpus, config, R))
+                success = false;
+        });
+    return success;
+}
+
 } // mrdox
 } // clang
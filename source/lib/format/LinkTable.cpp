@@ -0,0 +1,236 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "LinkTable.hpp"
+#include "Scheduler.hpp"
+#include <mrdox/Metadata.hpp>
+#include <llvm/ADT/StringExtras.h>
+#include <algorithm>
+#include <utility>
+
+namespace clang {
+namespace mrdox {
+
+namespace {
+
+struct ScopeDir
+{
+    Info const* I;
+    Scope const* scope;
+    std::string dir;
+};
+
+/*  Append a part of a symbol ID to each name
+    which is the same as another one, without
+    regard to case. The suffix goes before the
+    extension, if the name has one.
+
+    Two names which only differ in case would
+    otherwise be the same file on a file system
+    which ignores case. Every name of a group is
+    changed, so the result does not depend on
+    the order of the names.
+*/
+void
+disambiguate(
+    llvm::MutableArrayRef<std::string> names,
+    llvm::ArrayRef<SymbolID const*> ids)
+{
+    llvm::StringMap<std::size_t> count;
+    for(auto const& name : names)
+        ++count[llvm::StringRef(name).lower()];
+    for(std::size_t i = 0; i < names.size(); ++i)
+    {
+        std::string& name = names[i];
+        if(count[llvm::StringRef(name).lower()] < 2)
+            continue;
+        auto const dot = name.rfind('.');
+        std::string const suffix = "-" + llvm::toHex(
+            llvm::ArrayRef<std::uint8_t>(*ids[i]).take_front(4), true);
+        name.insert(dot == std::string::npos ? name.size() : dot, suffix);
+    }
+}
+
+void
+collectScopes(
+    Corpus const& corpus,
+    Info const& I,
+    Scope const& scope,
+    std::string const& dir,
+    llvm::function_ref<std::string(Info const&)> directory,
+    std::vector<ScopeDir>& scopes)
+{
+    scopes.push_back({ &I, &scope, dir });
+
+    std::vector<std::pair<Info const*, Scope const*>> children;
+    for(auto const& ref : scope.Namespaces)
+    {
+        auto const& J = corpus.get<NamespaceInfo>(ref.USR);
+        children.emplace_back(&J, &J.Children);
+    }
+    for(auto const& ref : scope.Records)
+    {
+        auto const& J = corpus.get<RecordInfo>(ref.USR);
+        children.emplace_back(&J, &J.Children);
+    }
+
+    std::vector<std::string> names;
+    std::vector<SymbolID const*> ids;
+    for(auto const& child : children)
+    {
+        names.push_back(directory(*child.first));
+        ids.push_back(&child.first->USR);
+    }
+    disambiguate(names, ids);
+
+    for(std::size_t i = 0; i < children.size(); ++i)
+        collectScopes(corpus, *children[i].first, *children[i].second,
+            dir + names[i] + "/", directory, scopes);
+}
+
+} // (anon)
+
+LinkTable
+LinkTable::
+build(
+    Corpus const& corpus,
+    llvm::function_ref<std::string(Info const&)> directory,
+    llvm::function_ref<Location(Info const&)> locate)
+{
+    std::vector<ScopeDir> scopes;
+    auto const& global = corpus.globalNamespace();
+    collectScopes(corpus, global, global.Children,
+        "", directory, scopes);
+
+    // A scope and its functions are located
+    // relative to the directory of the scope.
+    using Located = std::pair<SymbolID, Location>;
+    std::vector<std::vector<Located>> located(scopes.size());
+    corpus.scheduler().forEach(Phase::generate, scopes.size(),
+        [&](std::size_t i)
+        {
+            auto const& s = scopes[i];
+            auto& v = located[i];
+            v.reserve(1 + s.scope->Functions.size());
+            auto const add = [&](Info const& I)
+            {
+                Location loc = locate(I);
+                if(loc.page.empty())
+                    return;
+                loc.page.insert(0, s.dir);
+                v.emplace_back(I.USR, std::move(loc));
+            };
+            add(*s.I);
+            for(auto const& ref : s.scope->Functions)
+                add(corpus.get<FunctionInfo>(ref.USR));
+
+            // Symbols may share a page on purpose, as the
+            // overloads of a function do. Only the distinct
+            // pages of the scope are disambiguated, using
+            // the first symbol on each.
+            llvm::StringMap<std::size_t> first;
+            std::vector<std::string> names;
+            std::vector<SymbolID const*> ids;
+            for(auto& [id, loc] : v)
+            {
+                auto const result = first.try_emplace(loc.page, names.size());
+                if(! result.second)
+                    continue;
+                names.push_back(loc.page.substr(s.dir.size()));
+                ids.push_back(&id);
+            }
+            disambiguate(names, ids);
+            for(auto& [id, loc] : v)
+                loc.page = s.dir + names[first[loc.page]];
+        });
+
+    // Each distinct page is stored once
+    LinkTable t;
+    llvm::StringMap<std::uint32_t> pageIndex;
+    for(auto& v : located)
+    {
+        for(auto& [id, loc] : v)
+        {
+            auto const result = pageIndex.try_emplace(loc.page,
+                static_cast<std::uint32_t>(t.pages_.size()));
+            if(result.second)
+                t.pages_.push_back(std::move(loc.page));
+            t.entries_.try_emplace(llvm::toStringRef(id),
+                Entry{ result.first->getValue(), std::move(loc.anchor) });
+        }
+    }
+    return t;
+}
+
+llvm::StringRef
+LinkTable::
+page(
+    SymbolID const& id) const noexcept
+{
+    auto it = entries_.find(llvm::toStringRef(id));
+    if(it == entries_.end())
+        return {};
+    return pages_[it->getValue().page];
+}
+
+llvm::StringRef
+LinkTable::
+anchor(
+    SymbolID const& id) const noexcept
+{
+    auto it = entries_.find(llvm::toStringRef(id));
+    if(it == entries_.end())
+        return {};
+    return it->getValue().anchor;
+}
+
+bool
+LinkTable::
+link(
+    llvm::SmallVectorImpl<char>& dest,
+    llvm::StringRef fromPage,
+    SymbolID const& id) const
+{
+    auto it = entries_.find(llvm::toStringRef(id));
+    if(it == entries_.end())
+        return false;
+    auto const& e = it->getValue();
+    relativePath(dest, fromPage, pages_[e.page]);
+    if(! e.anchor.empty())
+    {
+        dest.push_back('#');
+        dest.append(e.anchor.begin(), e.anchor.end());
+    }
+    return true;
+}
+
+void
+LinkTable::
+relativePath(
+    llvm::SmallVectorImpl<char>& dest,
+    llvm::StringRef from,
+    llvm::StringRef to)
+{
+    // Length of the directories in common
+    std::size_t common = 0;
+    auto const n = std::min(from.size(), to.size());
+    for(std::size_t i = 0; i < n && from[i] == to[i]; ++i)
+        if(from[i] == '/')
+            common = i + 1;
+
+    auto const up = from.drop_front(common).count('/');
+    for(std::size_t i = 0; i < up; ++i)
+        dest.append({ '.', '.', '/' });
+    auto const rest = to.drop_front(common);
+    dest.append(rest.begin(), rest.end());
+}
+
+} // mrdox
+} // clang
@@ -0,0 +1,138 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_FORMAT_LINKTABLE_HPP
+#define MRDOX_SOURCE_FORMAT_LINKTABLE_HPP
+
+#include <mrdox/Corpus.hpp>
+#include <mrdox/MetadataFwd.hpp>
+#include <mrdox/meta/Types.hpp>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/STLFunctionalExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace mrdox {
+
+/** The page and anchor of every symbol in one layout of the output.
+
+    A generator which writes more than one page
+    builds the table once, before rendering, and
+    looks up every link in it. Pages are posix
+    style paths relative to the output directory,
+    so the link from one page to another only
+    depends on the prefix which they share.
+
+    Distinct pages never have the same path, even
+    on a file system which ignores case. Names in
+    one directory which are the same without regard
+    to case, such as those of unnamed records, each
+    get a part of the symbol ID appended.
+*/
+class LinkTable
+{
+public:
+    /** Where a layout puts a symbol.
+    */
+    struct Location
+    {
+        std::string page;
+        std::string anchor;
+    };
+
+    /** Return a table for a layout of the corpus.
+
+        The scopes are visited from the global
+        namespace down to give each its directory,
+        then the symbols of every scope are located
+        in parallel.
+
+        @param corpus The symbols to lay out.
+
+        @param directory A function which returns
+        the name of the directory of a namespace or
+        record, within the directory of its parent.
+        The global namespace uses the output directory.
+
+        @param locate A function which returns where
+        a namespace, record or function is written,
+        relative to the directory of its scope. That
+        is its own directory, for a namespace or a
+        record. A symbol whose page is empty is left
+        out. This may be called concurrently.
+    */
+    static
+    LinkTable
+    build(
+        Corpus const& corpus,
+        llvm::function_ref<std::string(Info const&)> directory,
+        llvm::function_ref<Location(Info const&)> locate);
+
+    /** Return the page of a symbol, or an empty string if it has none.
+    */
+    llvm::StringRef
+    page(
+        SymbolID const& id) const noexcept;
+
+    /** Return the anchor of a symbol within its page, which may be empty.
+    */
+    llvm::StringRef
+    anchor(
+        SymbolID const& id) const noexcept;
+
+    /** Append the link from a page to a symbol.
+
+        @return `false` if the symbol has no page.
+
+        @param dest The buffer to append to.
+
+        @param fromPage The page with the link.
+
+        @param id The symbol to link to.
+    */
+    bool
+    link(
+        llvm::SmallVectorImpl<char>& dest,
+        llvm::StringRef fromPage,
+        SymbolID const& id) const;
+
+    /** Append the relative path from one page to another.
+
+        Both paths are posix style and relative to
+        the same directory. The directories which
+        they have in common are skipped, and each
+        remaining directory of `from` adds a "..".
+    */
+    static
+    void
+    relativePath(
+        llvm::SmallVectorImpl<char>& dest,
+        llvm::StringRef from,
+        llvm::StringRef to);
+
+private:
+    struct Entry
+    {
+        std::uint32_t page;
+        std::string anchor;
+    };
+
+    std::vector<std::string> pages_;
+    llvm::StringMap<Entry> entries_;
+};
+
+} // mrdox
+} // clang
+
+#endif
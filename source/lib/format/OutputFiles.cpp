@@ -0,0 +1,307 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "OutputFiles.hpp"
+#include <mrdox/Error.hpp>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+#include <algorithm>
+#include <vector>
+
+namespace clang {
+namespace mrdox {
+
+namespace {
+
+llvm::Error
+replaceFile(
+    llvm::StringRef fileName,
+    llvm::StringRef contents)
+{
+    namespace fs = llvm::sys::fs;
+
+    std::string const tempPath = fileName.str() + ".tmp";
+    {
+        std::error_code ec;
+        llvm::raw_fd_ostream os(tempPath, ec, fs::OF_None);
+        if(ec)
+            return makeError("open the file '", tempPath, "' returned ", ec.message());
+        os << contents;
+        os.close();
+        if(os.has_error())
+        {
+            auto ec = os.error();
+            os.clear_error();
+            fs::remove(tempPath);
+            return makeError("write the file '", tempPath, "' returned ", ec.message());
+        }
+    }
+    if(auto ec = fs::rename(tempPath, fileName))
+    {
+        fs::remove(tempPath);
+        return makeError("rename '", tempPath, "' to '", fileName,
+            "' returned ", ec.message());
+    }
+    return llvm::Error::success();
+}
+
+bool
+sameContents(
+    llvm::StringRef fileName,
+    llvm::StringRef contents)
+{
+    std::uint64_t size;
+    if(llvm::sys::fs::file_size(fileName, size) || size != contents.size())
+        return false;
+    auto fileText = llvm::MemoryBuffer::getFile(fileName);
+    if(! fileText)
+        return false;
+    return (*fileText)->getBuffer() == contents;
+}
+
+/*  Return true if a file in the manifest is
+    inside the output directory. The manifest
+    may be stale or edited by hand, and its
+    files are removed when the output is done.
+    Both kinds of separator are checked, since
+    either one separates paths on Windows.
+*/
+bool
+isRelativeFile(
+    llvm::StringRef fileName)
+{
+    namespace path = llvm::sys::path;
+
+    if( fileName.empty() ||
+        path::has_root_name(fileName, path::Style::windows) ||
+        path::has_root_directory(fileName, path::Style::windows))
+        return false;
+    return std::none_of(
+        path::begin(fileName, path::Style::windows),
+        path::end(fileName),
+        [](llvm::StringRef part)
+        {
+            return part == "..";
+        });
+}
+
+} // (anon)
+
+llvm::Expected<bool>
+writeIfChanged(
+    llvm::StringRef fileName,
+    llvm::StringRef contents)
+{
+    if(sameContents(fileName, contents))
+        return false;
+    if(auto err = replaceFile(fileName, contents))
+        return err;
+    return true;
+}
+
+//------------------------------------------------
+
+OutputFiles::
+OutputFiles(
+    llvm::StringRef rootPath)
+    : rootPath_(rootPath)
+{
+    // A manifest which cannot be read is ignored,
+    // so the files are compared by their contents
+    // and no stale file is removed.
+    llvm::SmallString<0> manifestPath(rootPath_);
+    llvm::sys::path::append(manifestPath, manifestName);
+    auto fileText = llvm::MemoryBuffer::getFile(manifestPath);
+    if(! fileText)
+        return;
+    auto json = llvm::json::parse((*fileText)->getBuffer());
+    if(! json)
+    {
+        llvm::consumeError(json.takeError());
+        return;
+    }
+    auto const* entries = json->getAsArray();
+    if(! entries)
+        return;
+    for(auto const& value : *entries)
+    {
+        auto const* entry = value.getAsObject();
+        if(! entry)
+            continue;
+        auto file = entry->getString("file");
+        auto hash = entry->getString("hash");
+        auto source = entry->getString("source");
+        auto size = entry->getInteger("size");
+        Entry e;
+        if( ! file || ! isRelativeFile(*file) ||
+            ! hash || hash->getAsInteger(16, e.hash) ||
+            (source && source->getAsInteger(16, e.source)))
+            continue;
+        e.size = size ? static_cast<std::uint64_t>(*size) : 0;
+        previous_[*file] = e;
+    }
+}
+
+bool
+OutputFiles::
+keep(
+    llvm::StringRef fileName,
+    std::uint64_t source)
+{
+    namespace path = llvm::sys::path;
+
+    if(source == 0)
+        return false;
+    Entry e;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = previous_.find(fileName);
+        if(it == previous_.end() || it->second.source != source)
+            return false;
+        e = it->second;
+    }
+
+    // The file must still be the one written
+    llvm::SmallString<0> fullPath(rootPath_);
+    path::append(fullPath, path::Style::posix, fileName);
+    path::native(fullPath);
+    std::uint64_t size;
+    if( llvm::sys::fs::file_size(fullPath, size) ||
+        size != e.size)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_[fileName] = e;
+    return true;
+}
+
+llvm::Error
+OutputFiles::
+write(
+    llvm::StringRef fileName,
+    llvm::StringRef contents,
+    std::uint64_t source)
+{
+    namespace path = llvm::sys::path;
+
+    Entry e;
+    e.hash = llvm::xxHash64(contents);
+    e.source = source;
+    e.size = contents.size();
+    bool known = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        current_[fileName] = e;
+        auto it = previous_.find(fileName);
+        known = it != previous_.end() && it->second.hash == e.hash;
+    }
+
+    llvm::SmallString<0> fullPath(rootPath_);
+    path::append(fullPath, path::Style::posix, fileName);
+    path::native(fullPath);
+
+    // When the previous run wrote the same hash,
+    // the file is only checked for its size.
+    if(known)
+    {
+        std::uint64_t size;
+        if( ! llvm::sys::fs::file_size(fullPath, size) &&
+            size == contents.size())
+            return llvm::Error::success();
+    }
+    auto changed = writeIfChanged(fullPath, contents);
+    if(! changed)
+        return changed.takeError();
+    if(*changed)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++written_;
+    }
+    return llvm::Error::success();
+}
+
+llvm::Expected<std::size_t>
+OutputFiles::
+finish()
+{
+    namespace fs = llvm::sys::fs;
+    namespace path = llvm::sys::path;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Remove what the previous run wrote and this
+    // one did not, along with emptied directories.
+    for(auto const& e : previous_)
+    {
+        if(current_.count(e.getKey()))
+            continue;
+        llvm::SmallString<0> fullPath(rootPath_);
+        path::append(fullPath, path::Style::posix, e.getKey());
+        path::native(fullPath);
+        if(auto ec = fs::remove(fullPath))
+            return makeError("remove the file '", fullPath, "' returned ", ec.message());
+        for(;;)
+        {
+            path::remove_filename(fullPath);
+            if( fullPath.size() <= rootPath_.size() ||
+                fs::remove(fullPath, false))
+                break;
+        }
+    }
+
+    std::vector<std::pair<llvm::StringRef, Entry>> sorted;
+    sorted.reserve(current_.size());
+    for(auto const& e : current_)
+        sorted.emplace_back(e.getKey(), e.getValue());
+    std::sort(sorted.begin(), sorted.end(),
+        [](auto const& p0, auto const& p1)
+        {
+            return p0.first < p1.first;
+        });
+
+    std::string text;
+    {
+        llvm::raw_string_ostream os(text);
+        llvm::json::OStream J(os, 1);
+        J.array([&]
+        {
+            for(auto const& [file, e] : sorted)
+            {
+                J.object([&]
+                {
+                    J.attribute("file", file);
+                    J.attribute("hash", llvm::utohexstr(e.hash, true, 16));
+                    if(e.source != 0)
+                        J.attribute("source", llvm::utohexstr(e.source, true, 16));
+                    J.attribute("size", static_cast<int64_t>(e.size));
+                });
+            }
+        });
+        os << "\n";
+    }
+    llvm::SmallString<0> manifestPath(rootPath_);
+    path::append(manifestPath, manifestName);
+    auto changed = writeIfChanged(manifestPath, text);
+    if(! changed)
+        return changed.takeError();
+
+    previous_ = std::move(current_);
+    current_.clear();
+    return written_;
+}
+
+} // mrdox
+} // clang
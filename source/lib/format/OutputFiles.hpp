@@ -0,0 +1,134 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_FORMAT_OUTPUTFILES_HPP
+#define MRDOX_SOURCE_FORMAT_OUTPUTFILES_HPP
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace clang {
+namespace mrdox {
+
+/** Replace a file with new contents, unless it already has them.
+
+    The file is left untouched, including its
+    modification time, when its contents are
+    the same. Otherwise the contents are written
+    to a temporary file which then replaces the
+    file, so a reader never sees a partial file.
+
+    @return `true` if the file was written.
+
+    @param fileName The path to the file.
+
+    @param contents The new contents.
+*/
+llvm::Expected<bool>
+writeIfChanged(
+    llvm::StringRef fileName,
+    llvm::StringRef contents);
+
+/** The set of files written into an output directory.
+
+    A manifest in the directory records the hash
+    of every file written by the previous run, and
+    of what it was rendered from. A file whose
+    recorded hash matches is not even read, a file
+    whose source is unchanged is not rendered again,
+    and files which the previous run wrote
+    but this one did not are removed when the
+    output is finished. Files which were never
+    written by a generator are left alone.
+
+    @par Thread Safety
+    @ref keep and @ref write may be called concurrently.
+*/
+class OutputFiles
+{
+    struct Entry
+    {
+        std::uint64_t hash = 0;
+        std::uint64_t source = 0;
+        std::uint64_t size = 0;
+    };
+
+    std::string rootPath_;
+    std::mutex mutex_;
+    llvm::StringMap<Entry> previous_;
+    llvm::StringMap<Entry> current_;
+    std::size_t written_ = 0;
+
+public:
+    /** The name of the manifest file in the output directory.
+    */
+    static constexpr llvm::StringRef manifestName = ".mrdox-files.json";
+
+    /** Constructor.
+
+        The manifest is loaded, if the directory has one.
+
+        @param rootPath The output directory.
+    */
+    explicit
+    OutputFiles(
+        llvm::StringRef rootPath);
+
+    /** Keep a file from the previous run, if its source is unchanged.
+
+        When this returns `true` the file does not
+        need to be rendered, and it is kept as if
+        it had been written again.
+
+        @param fileName The posix-style path to
+        the file, relative to the output directory.
+
+        @param source The hash of everything the
+        contents of the file are rendered from.
+    */
+    bool
+    keep(
+        llvm::StringRef fileName,
+        std::uint64_t source);
+
+    /** Write a file, if its contents changed.
+
+        @param fileName The posix-style path to
+        the file, relative to the output directory.
+
+        @param contents The new contents.
+
+        @param source The hash of everything the
+        contents were rendered from, or zero if
+        this is not known.
+    */
+    llvm::Error
+    write(
+        llvm::StringRef fileName,
+        llvm::StringRef contents,
+        std::uint64_t source = 0);
+
+    /** Remove stale files and save the manifest.
+
+        @return The number of files which were
+        written, rather than left as they were.
+    */
+    llvm::Expected<std::size_t>
+    finish();
+};
+
+} // mrdox
+} // clang
+
+#endif
@@ -13,50 +13,81 @@
 #include <mrdox/format/OverloadSet.hpp>
 #include <mrdox/meta/Function.hpp>
 #include <mrdox/meta/Scope.hpp>
+#include <llvm/ADT/STLExtras.h>
+#include <algorithm>
 
 namespace clang {
 namespace mrdox {
 
-std::vector<OverloadSet>
-makeOverloadSet(
+static_assert(
+    AccessSpecifier::AS_public == 0 &&
+    AccessSpecifier::AS_protected == 1 &&
+    AccessSpecifier::AS_private == 2 &&
+    AccessSpecifier::AS_none == 3);
+
+ScopeOverloads::
+ScopeOverloads(
     Corpus const& corpus,
-    Scope const& scope,
-    std::function<bool(FunctionInfo const&)> filter)
+    Scope const& scope)
 {
-    std::vector<OverloadSet> result;
-    std::vector<FunctionInfo const*> list;
-    list.reserve(scope.Functions.size());
+    auto const n = scope.Functions.size();
+    functions_.reserve(n);
     for(auto const& ref : scope.Functions)
-    {
-        auto const& I = corpus.get<FunctionInfo>(ref.USR);
-        if(filter(I))
-            list.push_back(&I);
-    }
-    if(list.empty())
-        return {};
-    std::sort(list.begin(), list.end(),
+        functions_.push_back(&corpus.get<FunctionInfo>(ref.USR));
+    bool const mixed = std::any_of(
+        functions_.begin(), functions_.end(),
+        [&](FunctionInfo const* I)
+        {
+            return I->Access != functions_.front()->Access;
+        });
+    llvm::stable_sort(functions_,
         []( FunctionInfo const* f0,
             FunctionInfo const* f1)
         {
+            if(f0->Access != f1->Access)
+                return f0->Access < f1->Access;
             return f0->Name < f1->Name;
         });
-    auto it0 = list.begin();
-    auto it = it0;
-    do
+    if(mixed)
     {
-        ++it;
-        if( it == list.end() ||
-            (*it)->Name != (*it0)->Name)
+        for(auto const& ref : scope.Functions)
+            functions_.push_back(&corpus.get<FunctionInfo>(ref.USR));
+        std::stable_sort(
+            functions_.begin() + n, functions_.end(),
+            []( FunctionInfo const* f0,
+                FunctionInfo const* f1)
+            {
+                return f0->Name < f1->Name;
+            });
+    }
+
+    // The array is complete, so the
+    // sets can now refer to it.
+    auto const group = [&](std::size_t first, std::size_t last)
+    {
+        while(first < last)
         {
-            result.emplace_back(
-                OverloadSet{
-                    (*it0)->Name,
-                    std::vector<FunctionInfo const*>(it0, it)});
-            it0 = it;
+            auto it = first + 1;
+            while(it < last && functions_[it]->Name == functions_[first]->Name)
+                ++it;
+            sets_.push_back({ functions_[first]->Name,
+                llvm::makeArrayRef(functions_).slice(first, it - first) });
+            first = it;
         }
+    };
+    std::size_t first = 0;
+    for(unsigned access = 0; access < 4; ++access)
+    {
+        first_[access] = static_cast<std::uint32_t>(sets_.size());
+        auto last = first;
+        while(last < n && static_cast<unsigned>(functions_[last]->Access) == access)
+            ++last;
+        group(first, last);
+        first = last;
     }
-    while(it != list.end());
-    return result;
+    first_[4] = static_cast<std::uint32_t>(sets_.size());
+    if(mixed)
+        group(n, functions_.size());
 }
 
 } // mrdox
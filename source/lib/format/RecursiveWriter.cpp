@@ -9,12 +9,14 @@
 // Official repository: https://github.com/cppalliance/mrdox
 //
 
+#include "Scheduler.hpp"
 #include <mrdox/format/RecursiveWriter.hpp>
 #include <mrdox/Config.hpp>
 #include <mrdox/Corpus.hpp>
 #include <mrdox/Metadata.hpp>
 #include <mrdox/Reporter.hpp>
 #include <llvm/ADT/StringRef.h>
+#include <atomic>
 #include <cassert>
 
 namespace clang {
@@ -77,11 +79,18 @@ RecursiveWriter::
 write()
 {
     beginFile();
-    writeAllSymbols(makeAllSymbols());
-    visit(corpus_.get<NamespaceInfo>(EmptySID));
+    visitGlobal(corpus_.get<NamespaceInfo>(EmptySID));
     endFile();
 }
 
+std::unique_ptr<RecursiveWriter>
+RecursiveWriter::
+makeSubWriter(
+    llvm::raw_ostream&)
+{
+    return nullptr;
+}
+
 void
 RecursiveWriter::
 beginFile()
@@ -234,6 +243,84 @@ visit(
         writeTypedef(J);
 }
 
+void
+RecursiveWriter::
+visitGlobal(
+    NamespaceInfo const& I)
+{
+    Scheduler& scheduler = corpus_.scheduler();
+    Scope const& scope = I.Children;
+
+    // The parts are the list of all symbols
+    // followed by each child of the scope,
+    // in the order they are visited.
+    std::size_t const n = 1 +
+        scope.Namespaces.size() +
+        scope.Records.size() +
+        scope.Functions.size();
+    if( n < 3 ||
+        scheduler.concurrency(Phase::generate) < 2)
+    {
+        writeAllSymbols(makeAllSymbols());
+        visit(I);
+        return;
+    }
+
+    std::vector<std::string> parts(n);
+    std::string const outerIndent = indentString_;
+    std::string const innerIndent = outerIndent + "  ";
+    std::atomic<bool> serial = false;
+    scheduler.forEach(Phase::generate, n,
+        [&](std::size_t i)
+        {
+            llvm::raw_string_ostream os(parts[i]);
+            auto w = makeSubWriter(os);
+            if(! w)
+            {
+                serial = true;
+                return;
+            }
+            if(i == 0)
+            {
+                w->indentString_ = outerIndent;
+                w->writeAllSymbols(w->makeAllSymbols());
+                return;
+            }
+            w->indentString_ = innerIndent;
+            --i;
+            if(i < scope.Namespaces.size())
+                return w->visit(corpus_.get<NamespaceInfo>(
+                    scope.Namespaces[i].USR));
+            i -= scope.Namespaces.size();
+            if(i < scope.Records.size())
+                return w->visit(corpus_.get<RecordInfo>(
+                    scope.Records[i].USR));
+            i -= scope.Records.size();
+            w->visit(corpus_.get<FunctionInfo>(
+                scope.Functions[i].USR));
+        });
+    if(serial)
+    {
+        writeAllSymbols(makeAllSymbols());
+        visit(I);
+        return;
+    }
+
+    // Splice the parts in, as visit(I) would have written them
+    os_ << parts[0];
+    beginNamespace(I);
+    adjustNesting(1);
+    writeNamespace(I);
+    for(std::size_t i = 1; i < n; ++i)
+        os_ << parts[i];
+    for(auto const& J : scope.Enums)
+        writeEnum(J);
+    for(auto const& J : scope.Typedefs)
+        writeTypedef(J);
+    adjustNesting(-1);
+    endNamespace(I);
+}
+
 auto
 RecursiveWriter::
 makeAllSymbols() ->
@@ -0,0 +1,406 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "SearchIndex.hpp"
+#include "Scheduler.hpp"
+#include <mrdox/Metadata.hpp>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+namespace clang {
+namespace mrdox {
+
+namespace {
+
+// Entries between two full names
+constexpr std::size_t restartInterval = 16;
+
+// Longest brief, in bytes
+constexpr std::size_t maxBrief = 160;
+
+struct SearchEntry
+{
+    std::string key;
+    std::string name;
+    std::string scope;
+    llvm::StringRef kind;
+    llvm::StringRef page;
+    llvm::StringRef anchor;
+    std::string brief;
+
+    bool
+    operator<(
+        SearchEntry const& other) const noexcept
+    {
+        return
+            std::tie(key, name, scope, page, kind, anchor, brief) <
+            std::tie(other.key, other.name, other.scope, other.page,
+                other.kind, other.anchor, other.brief);
+    }
+};
+
+/*  Remove an incomplete UTF-8 sequence
+    from the end of a string.
+*/
+void
+trimUTF8(
+    std::string& s)
+{
+    std::size_t i = s.size();
+    while(i > 0 && (static_cast<unsigned char>(s[i - 1]) & 0xC0) == 0x80)
+        --i;
+    if(i == 0)
+        return;
+    auto const lead = static_cast<unsigned char>(s[i - 1]);
+    std::size_t const len =
+        lead >= 0xF0 ? 4 :
+        lead >= 0xE0 ? 3 :
+        lead >= 0xC0 ? 2 : 1;
+    if(i - 1 + len > s.size())
+        s.resize(i - 1);
+}
+
+/*  Append the text of a brief on one line,
+    with each run of whitespace made a space.
+*/
+void
+appendBrief(
+    std::string& dest,
+    Javadoc::Paragraph const* brief)
+{
+    if(! brief)
+        return;
+    bool space = false;
+    for(Javadoc::Text const& text : brief->children)
+    {
+        for(char c : text.string)
+        {
+            if(llvm::isSpace(c))
+            {
+                space = ! dest.empty();
+                continue;
+            }
+            if(dest.size() + space >= maxBrief)
+            {
+                trimUTF8(dest);
+                return;
+            }
+            if(space)
+                dest.push_back(' ');
+            space = false;
+            dest.push_back(c);
+        }
+        space = ! dest.empty();
+    }
+}
+
+/*  Return the number of leading characters two
+    names share. Only ASCII characters are shared,
+    so the count is the same in the loader, which
+    counts UTF-16 code units instead of bytes.
+*/
+std::size_t
+sharedPrefix(
+    llvm::StringRef s0,
+    llvm::StringRef s1) noexcept
+{
+    auto const n = std::min(s0.size(), s1.size());
+    std::size_t i = 0;
+    while( i < n && s0[i] == s1[i] &&
+            static_cast<unsigned char>(s0[i]) < 0x80)
+        ++i;
+    return i;
+}
+
+/*  Numbers the distinct strings of one column,
+    in the order in which they are first used.
+*/
+class StringTable
+{
+    llvm::StringMap<std::size_t> index_;
+    std::vector<llvm::StringRef> list_;
+
+public:
+    std::size_t
+    insert(
+        llvm::StringRef s)
+    {
+        auto const result = index_.try_emplace(s, list_.size());
+        if(result.second)
+            list_.push_back(s);
+        return result.first->getValue();
+    }
+
+    void
+    write(
+        llvm::raw_ostream& os,
+        llvm::StringRef name) const
+    {
+        os << name << ' ' << list_.size() << '\n';
+        for(auto const& s : list_)
+            os << s << '\n';
+    }
+};
+
+} // (anon)
+
+void
+buildSearchIndex(
+    std::string& dest,
+    Corpus const& corpus,
+    LinkTable const& links)
+{
+    // Each symbol is described on its own
+    std::vector<SearchEntry> entries(corpus.allSymbols.size());
+    corpus.scheduler().forEach(Phase::generate, entries.size(),
+        [&](std::size_t i)
+        {
+            auto const& id = corpus.allSymbols[i];
+            if(id == EmptySID)
+                return;
+            auto& e = entries[i];
+            e.page = links.page(id);
+            if(e.page.empty())
+                return;
+            auto const& I = corpus.get<Info>(id);
+            e.name = I.extractName().str();
+            e.key = llvm::StringRef(e.name).lower();
+            for(auto const& ref : llvm::reverse(I.Namespace))
+            {
+                if(ref.USR == EmptySID)
+                    continue;
+                if(! e.scope.empty())
+                    e.scope.append("::");
+                e.scope.append(ref.Name.data(), ref.Name.size());
+            }
+            e.kind = I.symbolType();
+            e.anchor = links.anchor(id);
+            appendBrief(e.brief, I.javadoc.getBrief());
+        });
+    entries.erase(
+        std::remove_if(entries.begin(), entries.end(),
+            [](SearchEntry const& e)
+            {
+                return e.page.empty();
+            }),
+        entries.end());
+    std::sort(entries.begin(), entries.end());
+
+    // The functions of an overload set share a
+    // page, and are found once, by the first.
+    entries.erase(
+        std::unique(entries.begin(), entries.end(),
+            [](SearchEntry const& e0, SearchEntry const& e1)
+            {
+                return
+                    std::tie(e0.name, e0.scope, e0.page) ==
+                    std::tie(e1.name, e1.scope, e1.page);
+            }),
+        entries.end());
+
+    // The tables are numbered in the order of
+    // the entries, which is always the same.
+    StringTable kinds;
+    StringTable pages;
+    StringTable scopes;
+    for(auto const& e : entries)
+    {
+        kinds.insert(e.kind);
+        pages.insert(e.page);
+        scopes.insert(e.scope);
+    }
+
+    dest.clear();
+    llvm::raw_string_ostream os(dest);
+    os << "mrdox-search 1\n";
+    kinds.write(os, "kinds");
+    pages.write(os, "pages");
+    scopes.write(os, "scopes");
+    os << "symbols " << entries.size() << ' ' << restartInterval << '\n';
+    for(std::size_t i = 0; i < entries.size(); ++i)
+    {
+        auto const& e = entries[i];
+        std::size_t const shared = i % restartInterval == 0 ?
+            0 : sharedPrefix(entries[i - 1].name, e.name);
+        os <<
+            shared << '\t' <<
+            llvm::StringRef(e.name).drop_front(shared) << '\t' <<
+            kinds.insert(e.kind) << '\t' <<
+            scopes.insert(e.scope) << '\t' <<
+            pages.insert(e.page) << '\t' <<
+            e.anchor << '\t' <<
+            e.brief << '\n';
+    }
+}
+
+llvm::StringRef
+searchIndexLoader() noexcept
+{
+    return
+R"js(// Loads and queries a search index written by mrdox.
+//
+//   mrdoxSearch.load("search-index.txt").then(function(index) {
+//       var results = index.search("std::vec", 20);
+//   });
+//
+// Each result has a name, a qualified name, a kind, a
+// url and a brief. Urls are relative to the index and
+// end in ".html", unless the options given to load()
+// have another "base" or "extension".
+(function(root) {
+"use strict";
+
+// Only ASCII is folded, like the index itself
+function lower(s) {
+    return s.replace(/[A-Z]+/g, function(c) { return c.toLowerCase(); });
+}
+
+function field(line, n) {
+    var first = 0;
+    for(var i = 0; i < n; ++i)
+        first = line.indexOf("\t", first) + 1;
+    var last = line.indexOf("\t", first);
+    return line.substring(first, last < 0 ? line.length : last);
+}
+
+function Index(text, options) {
+    var lines = text.split("\n");
+    var at = 0;
+    if(lines[at++] !== "mrdox-search 1")
+        throw new Error("unknown search index format");
+    function table(name) {
+        var head = lines[at++].split(" ");
+        if(head[0] !== name)
+            throw new Error("missing " + name + " in the search index");
+        var n = +head[1];
+        at += n;
+        return lines.slice(at - n, at);
+    }
+    this.kinds = table("kinds");
+    this.pages = table("pages");
+    this.scopes = table("scopes");
+    var head = lines[at++].split(" ");
+    this.size = +head[1];
+    this.restart = +head[2];
+    this.lines = lines.slice(at, at + this.size);
+    options = options || {};
+    this.base = options.base || "";
+    this.extension = options.extension !== undefined ?
+        options.extension : ".html";
+}
+
+// Return the names of the entries in a block
+Index.prototype.block = function(b) {
+    var names = [];
+    var last = Math.min((b + 1) * this.restart, this.size);
+    var name = "";
+    for(var i = b * this.restart; i < last; ++i) {
+        var line = this.lines[i];
+        name = name.substring(0, +field(line, 0)) + field(line, 1);
+        names.push(name);
+    }
+    return names;
+};
+
+Index.prototype.entry = function(i, name) {
+    var line = this.lines[i];
+    var scope = this.scopes[+field(line, 3)];
+    var page = this.pages[+field(line, 4)].replace(/\.adoc$/, this.extension);
+    var anchor = field(line, 5);
+    return {
+        name: name,
+        qualifiedName: scope ? scope + "::" + name : name,
+        kind: this.kinds[+field(line, 2)],
+        url: this.base + page + (anchor ? "#" + anchor : ""),
+        brief: field(line, 6)
+    };
+};
+
+// True if a scope ends with whole names of another
+function inScope(s, scope) {
+    var at = s.length - scope.length;
+    if(at < 0 || s.substring(at) !== scope)
+        return false;
+    return at === 0 || s.substring(at - 2, at) === "::";
+}
+
+// Return up to `limit` symbols whose name starts with
+// the query, without regard to case. In a query such
+// as "std::vec", the part before the last "::" must
+// match whole names at the end of the scope of the
+// symbol, so "d::vec" does not find "std::vector".
+Index.prototype.search = function(query, limit) {
+    limit = limit || 50;
+    var sep = query.lastIndexOf("::");
+    var scope = sep < 0 ? "" : lower(query.substring(0, sep));
+    var prefix = lower(sep < 0 ? query : query.substring(sep + 2));
+
+    // Find the first block which starts at or after
+    // the prefix. Matches may begin in the block before.
+    var blocks = Math.ceil(this.size / this.restart);
+    var lo = 0;
+    var hi = blocks;
+    while(lo < hi) {
+        var mid = (lo + hi) >> 1;
+        if(lower(field(this.lines[mid * this.restart], 1)) < prefix)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    var results = [];
+    for(var b = Math.max(lo - 1, 0); b < blocks; ++b) {
+        var names = this.block(b);
+        for(var j = 0; j < names.length; ++j) {
+            var key = lower(names[j]);
+            if(key < prefix)
+                continue;
+            if(key.substring(0, prefix.length) !== prefix)
+                return results;
+            var i = b * this.restart + j;
+            if(scope) {
+                var s = lower(this.scopes[+field(this.lines[i], 3)]);
+                if(! inScope(s, scope))
+                    continue;
+            }
+            results.push(this.entry(i, names[j]));
+            if(results.length >= limit)
+                return results;
+        }
+    }
+    return results;
+};
+
+root.mrdoxSearch = {
+    Index: Index,
+    load: function(url, options) {
+        options = Object.assign({
+            base: url.substring(0, url.lastIndexOf("/") + 1)
+        }, options);
+        return fetch(url).then(function(response) {
+            if(! response.ok)
+                throw new Error("fetch " + url + " returned " + response.status);
+            return response.text();
+        }).then(function(text) {
+            return new Index(text, options);
+        });
+    }
+};
+})(typeof self !== "undefined" ? self : this);
+)js";
+}
+
+} // mrdox
+} // clang
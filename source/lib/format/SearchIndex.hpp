@@ -0,0 +1,59 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_FORMAT_SEARCHINDEX_HPP
+#define MRDOX_SOURCE_FORMAT_SEARCHINDEX_HPP
+
+#include "LinkTable.hpp"
+#include <mrdox/Corpus.hpp>
+#include <llvm/ADT/StringRef.h>
+#include <string>
+
+namespace clang {
+namespace mrdox {
+
+/** Build the search index of multi-page output.
+
+    Every symbol which has a page in the link
+    table is listed with its name, scope, kind,
+    page, anchor and brief. The entries are sorted
+    by name without regard to case, so a query is
+    a binary search for its prefix.
+
+    The index is UTF-8 text made of lines, and
+    starts with tables of the kinds, pages and
+    scopes, which entries refer to by number.
+    Each entry holds the number of characters its
+    name shares with the name before it, followed
+    by the rest of the name. Every sixteenth entry
+    restarts with its full name, so a search only
+    decodes the entries of one block.
+
+    @param dest The string to hold the index.
+
+    @param corpus The symbols to list.
+
+    @param links The pages of the symbols.
+*/
+void
+buildSearchIndex(
+    std::string& dest,
+    Corpus const& corpus,
+    LinkTable const& links);
+
+/** Return the script which loads and queries the search index.
+*/
+llvm::StringRef
+searchIndexLoader() noexcept;
+
+} // mrdox
+} // clang
+
+#endif
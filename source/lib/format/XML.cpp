@@ -10,6 +10,7 @@
 //
 
 #include "base64.hpp"
+#include "OutputFiles.hpp"
 #include "XML.hpp"
 #include <mrdox/Metadata.hpp>
 
@@ -26,24 +27,16 @@ bool
 XMLGenerator::
 buildOne(
     llvm::StringRef fileName,
-    Corpus& corpus,
+    Corpus const& corpus,
     Config const& config,
     Reporter& R) const
 {
-    namespace fs = llvm::sys::fs;
-
-    std::error_code ec;
-    llvm::raw_fd_ostream os(
-        fileName,
-        ec,
-        fs::CD_CreateAlways,
-        fs::FA_Write,
-        fs::OF_None);
-    if(R.error(ec, "open a stream for '", fileName, "'"))
+    std::string text;
+    if(! buildString(text, corpus, config, R))
+        return false;
+    auto changed = writeIfChanged(fileName, text);
+    if(R.error(changed, "write the file '", fileName, "'"))
         return false;
-
-    Writer w(os, corpus, config, R);
-    w.write();
     return true;
 }
 
@@ -51,7 +44,7 @@ bool
 XMLGenerator::
 buildString(
     std::string& dest,
-    Corpus& corpus,
+    Corpus const& corpus,
     Config const& config,
     Reporter& R) const
 {
@@ -69,84 +62,6 @@ buildString(
 //
 //------------------------------------------------
 
-/** Manipulator to apply XML escaping to output.
-*/
-struct XMLGenerator::Writer::
-    escape
-{
-    explicit
-    escape(
-        llvm::StringRef const& s) noexcept
-        : s_(s)
-    {
-    }
-
-    friend
-    llvm::raw_ostream&
-    operator<<(
-        llvm::raw_ostream& os,
-        escape const& t)
-    {
-        t.write(os);
-        return os;
-    }
-
-private:
-    void write(llvm::raw_ostream& os) const;
-
-    llvm::StringRef s_;
-};
-
-void
-XMLGenerator::
-Writer::
-escape::
-write(
-    llvm::raw_ostream& os) const
-{
-    std::size_t pos = 0;
-    auto const size = s_.size();
-    while(pos < size)
-    {
-    unescaped:
-        auto const found = s_.find_first_of("<>&'\"", pos);
-        if(found == llvm::StringRef::npos)
-        {
-            os.write(s_.data() + pos, s_.size() - pos);
-            break;
-        }
-        os.write(s_.data() + pos, found - pos);
-        pos = found;
-        while(pos < size)
-        {
-            auto const c = s_[pos];
-            switch(c)
-            {
-            case '<':
-                os.write("&lt;", 4);
-                break;
-            case '>':
-                os.write("&gt;", 4);
-                break;
-            case '&':
-                os.write("&amp;", 5);
-                break;
-            case '\'':
-                os.write("&apos;", 6);
-                break;
-            case '\"':
-                os.write("&quot;", 6);
-                break;
-            default:
-                goto unescaped;
-            }
-            ++pos;
-        }
-    }
-}
-
-//------------------------------------------------
-
 XMLGenerator::
 Writer::
 Writer(
@@ -158,6 +73,15 @@ Writer(
 {
 }
 
+std::unique_ptr<RecursiveWriter>
+XMLGenerator::
+Writer::
+makeSubWriter(
+    llvm::raw_ostream& os)
+{
+    return std::make_unique<Writer>(os, corpus_, config_, R_);
+}
+
 //------------------------------------------------
 
 void
@@ -374,7 +298,12 @@ writeTypedef(
     writeInfo(I);
     writeSymbol(I);
     if(I.Underlying.Type.USR != EmptySID)
-        writeTagLine("qualusr", toBase64(I.Underlying.Type.USR));
+    {
+        auto const& USR = I.Underlying.Type.USR;
+        char buf[base64Size(sizeof(SymbolID))];
+        writeTagLine("qualusr", llvm::StringRef(
+            buf, toBase64(buf, USR.data(), USR.size())));
+    }
     adjustNesting(-1);
     closeTag("typedef");
 }
@@ -411,7 +340,7 @@ writeLocation(
 {
     writeTag("file", {
         { "path", loc.Filename },
-        { "line", std::to_string(loc.LineNumber) },
+        { "line", loc.LineNumber },
         { "class", "def", def } });
 }
 
@@ -781,24 +710,11 @@ Writer::
 writeAttrs(
     Attrs attrs)
 {
-    for(auto const& attr : attrs)
-        if(attr.pred)
-            os_ <<
-                ' ' << attr.name << '=' <<
-                "\"" << escape(attr.value) << "\"";
+    xml::writeAttrs(os_, attrs);
 }
 
 //------------------------------------------------
 
-std::string
-XMLGenerator::
-Writer::
-toString(
-    SymbolID const& id)
-{
-    return toBase64(id);
-}
-
 llvm::StringRef
 XMLGenerator::
 Writer::
@@ -12,6 +12,7 @@
 #ifndef MRDOX_SOURCE_XML_HPP
 #define MRDOX_SOURCE_XML_HPP
 
+#include "XMLTags.hpp"
 #include <mrdox/MetadataFwd.hpp>
 #include <mrdox/format/Generator.hpp>
 #include <mrdox/format/RecursiveWriter.hpp>
@@ -40,14 +41,14 @@ struct XMLGenerator : Generator
     bool
     buildOne(
         llvm::StringRef fileName,
-        Corpus& corpus,
+        Corpus const& corpus,
         Config const& config,
         Reporter& R) const override;
 
     bool
     buildString(
         std::string& dest,
-        Corpus& corpus,
+        Corpus const& corpus,
         Config const& config,
         Reporter& R) const override;
 };
@@ -67,8 +68,11 @@ public:
         Reporter& R) noexcept;
 
 private:
-    struct Attr;
-    using Attrs = std::initializer_list<Attr>;
+    using escape = xml::escape;
+    using Attr = xml::Attr;
+    using Attrs = xml::Attrs;
+
+    std::unique_ptr<RecursiveWriter> makeSubWriter(llvm::raw_ostream& os) override;
 
     void writeAllSymbols(std::vector<AllSymbol> const& list) override;
 
@@ -123,43 +127,7 @@ private:
     void writeTagLine(llvm::StringRef tag, llvm::StringRef value, Attrs);
     void writeAttrs(Attrs attrs);
 
-    static std::string toString(SymbolID const& id);
     static llvm::StringRef toString(InfoType) noexcept;
-
-    //--------------------------------------------
-
-    struct escape;
-
-    struct Attr
-    {
-        llvm::StringRef name;
-        std::string value;
-        bool pred;
-
-        Attr(
-            llvm::StringRef name_,
-            llvm::StringRef value_,
-            bool pred_ = true) noexcept
-            : name(name_)
-            , value(value_)
-            , pred(pred_)
-        {
-        }
-
-        Attr(AccessSpecifier access) noexcept
-            : name("access")
-            , value(clang::getAccessSpelling(access))
-            , pred(access != AccessSpecifier::AS_none)
-        {
-        }
-
-        Attr(SymbolID USR)
-            : name("id")
-            , value(toString(USR))
-            , pred(USR != EmptySID)
-        {
-        }
-    };
 };
 
 //------------------------------------------------
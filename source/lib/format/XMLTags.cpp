@@ -0,0 +1,107 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "XMLTags.hpp"
+#include "CharScanner.hpp"
+
+namespace clang {
+namespace mrdox {
+namespace xml {
+
+void
+escape::
+write(
+    llvm::raw_ostream& os) const
+{
+    static CharScanner const scanner(chars);
+
+    std::size_t pos = 0;
+    auto const size = s_.size();
+    while(pos < size)
+    {
+    unescaped:
+        auto const found = scanner.find(s_, pos);
+        if(found == llvm::StringRef::npos)
+        {
+            os.write(s_.data() + pos, s_.size() - pos);
+            break;
+        }
+        os.write(s_.data() + pos, found - pos);
+        pos = found;
+        while(pos < size)
+        {
+            auto const c = s_[pos];
+            switch(c)
+            {
+            case '<':
+                os.write("&lt;", 4);
+                break;
+            case '>':
+                os.write("&gt;", 4);
+                break;
+            case '&':
+                os.write("&amp;", 5);
+                break;
+            case '\'':
+                os.write("&apos;", 6);
+                break;
+            case '\"':
+                os.write("&quot;", 6);
+                break;
+            default:
+                goto unescaped;
+            }
+            ++pos;
+        }
+    }
+}
+
+//------------------------------------------------
+
+Attr::
+Attr(
+    llvm::StringRef name,
+    int value) noexcept
+    : name_(name)
+    , pred_(true)
+{
+    // Digits are produced in reverse
+    char digits[16];
+    std::size_t n = 0;
+    unsigned u = value < 0 ?
+        0u - static_cast<unsigned>(value) :
+        static_cast<unsigned>(value);
+    do
+    {
+        digits[n++] = static_cast<char>('0' + u % 10);
+        u /= 10;
+    }
+    while(u != 0);
+    if(value < 0)
+        buf_[len_++] = '-';
+    while(n > 0)
+        buf_[len_++] = digits[--n];
+}
+
+void
+writeAttrs(
+    llvm::raw_ostream& os,
+    Attrs attrs)
+{
+    for(auto const& attr : attrs)
+        if(attr.pred())
+            os <<
+                ' ' << attr.name() << '=' <<
+                "\"" << escape(attr.value()) << "\"";
+}
+
+} // xml
+} // mrdox
+} // clang
@@ -0,0 +1,141 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#ifndef MRDOX_SOURCE_FORMAT_XMLTAGS_HPP
+#define MRDOX_SOURCE_FORMAT_XMLTAGS_HPP
+
+#include "base64.hpp"
+#include <mrdox/meta/Types.hpp>
+#include <clang/Basic/Specifiers.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/raw_ostream.h>
+#include <initializer_list>
+
+namespace clang {
+namespace mrdox {
+namespace xml {
+
+/** Manipulator to apply XML escaping to output.
+*/
+struct escape
+{
+    /** The characters which are escaped.
+    */
+    static constexpr llvm::StringRef chars = "<>&'\"";
+
+    explicit
+    escape(
+        llvm::StringRef const& s) noexcept
+        : s_(s)
+    {
+    }
+
+    friend
+    llvm::raw_ostream&
+    operator<<(
+        llvm::raw_ostream& os,
+        escape const& t)
+    {
+        t.write(os);
+        return os;
+    }
+
+private:
+    void write(llvm::raw_ostream& os) const;
+
+    llvm::StringRef s_;
+};
+
+//------------------------------------------------
+
+/** An attribute of an XML tag.
+
+    Strings are referenced rather than copied,
+    and symbol IDs and numbers are formatted into
+    a buffer inside the attribute, so building a
+    list of attributes never allocates.
+*/
+class Attr
+{
+    static constexpr std::size_t bufSize =
+        base64Size(sizeof(SymbolID));
+
+    llvm::StringRef name_;
+    llvm::StringRef value_;
+    std::size_t len_ = 0;
+    bool pred_;
+    char buf_[bufSize];
+
+public:
+    Attr(
+        llvm::StringRef name,
+        llvm::StringRef value,
+        bool pred = true) noexcept
+        : name_(name)
+        , value_(value)
+        , pred_(pred)
+    {
+    }
+
+    Attr(
+        llvm::StringRef name,
+        int value) noexcept;
+
+    Attr(AccessSpecifier access) noexcept
+        : name_("access")
+        , value_(clang::getAccessSpelling(access))
+        , pred_(access != AccessSpecifier::AS_none)
+    {
+    }
+
+    Attr(SymbolID const& USR) noexcept
+        : name_("id")
+        , len_(toBase64(buf_, USR.data(), USR.size()))
+        , pred_(USR != EmptySID)
+    {
+    }
+
+    /** Return true if the attribute is written.
+    */
+    bool
+    pred() const noexcept
+    {
+        return pred_;
+    }
+
+    llvm::StringRef
+    name() const noexcept
+    {
+        return name_;
+    }
+
+    llvm::StringRef
+    value() const noexcept
+    {
+        if(len_ != 0)
+            return llvm::StringRef(buf_, len_);
+        return value_;
+    }
+};
+
+using Attrs = std::initializer_list<Attr>;
+
+/** Write a list of attributes, each preceded by a space.
+*/
+void
+writeAttrs(
+    llvm::raw_ostream& os,
+    Attrs attrs);
+
+} // xml
+} // mrdox
+} // clang
+
+#endif
@@ -27,28 +27,14 @@ get_alphabet()
     return &tab[0];
 }
 
-static
-std::size_t constexpr
-encoded_size(
-    std::size_t n)
-{
-    return 4 * ((n + 2) / 3);
-}
-
-/** Encode a series of octets as a padded, base64 string.
-    The resulting string will not be null terminated.
-    @par Requires
-    The memory pointed to by `out` points to valid memory
-    of at least `encoded_size(len)` bytes.
-    @return The number of characters written to `out`. This
-    will exclude any null termination.
-*/
-static
 std::size_t
-encode(void* dest, void const* src, std::size_t len)
+toBase64(
+    char* dest,
+    void const* src,
+    std::size_t len) noexcept
 {
-    char*      out = static_cast<char*>(dest);
-    char const* in = static_cast<char const*>(src);
+    char*      out = dest;
+    auto const* in = static_cast<unsigned char const*>(src);
     auto const tab = get_alphabet();
 
     for(auto n = len / 3; n--;)
@@ -80,7 +66,7 @@ encode(void* dest, void const* src, std::size_t len)
         break;
     }
 
-    return out - static_cast<char*>(dest);
+    return out - dest;
 }
 
 std::string
@@ -88,8 +74,8 @@ toBase64(
     std::array<uint8_t, 20> const& v)
 {
     std::string s;
-    s.resize(encoded_size(v.size()));
-    encode(&s[0], v.data(), v.size());
+    s.resize(base64Size(v.size()));
+    toBase64(&s[0], v.data(), v.size());
     return s;
 }
 
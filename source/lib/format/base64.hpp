@@ -13,12 +13,37 @@
 #define MRDOX_XML_BASE64_HPP
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
 namespace clang {
 namespace mrdox {
 
+/** Return the number of characters in the padded base64 encoding of n octets.
+*/
+constexpr
+std::size_t
+base64Size(
+    std::size_t n) noexcept
+{
+    return 4 * ((n + 2) / 3);
+}
+
+/** Encode a series of octets as a padded, base64 string.
+
+    The memory at `dest` must hold at least
+    `base64Size(len)` characters. No null is
+    appended.
+
+    @return The number of characters written.
+*/
+std::size_t
+toBase64(
+    char* dest,
+    void const* src,
+    std::size_t len) noexcept;
+
 std::string toBase64(std::array<uint8_t, 20> const& v);
 
 } // mrdox
@@ -34,10 +34,12 @@ namespace mrdox {
 // on members on the forward declaration, but would have the class name).
 //
 
-template <typename T>
+// The values may be any owning pointer to Info,
+// such as the ones returned by a decoder.
+template <typename T, typename Ptr>
 llvm::Expected<std::unique_ptr<Info>>
 reduce(
-    std::vector<std::unique_ptr<Info>>& Values)
+    std::vector<Ptr>& Values)
 {
     if (Values.empty() || !Values[0])
         return llvm::createStringError(llvm::inconvertibleErrorCode(),
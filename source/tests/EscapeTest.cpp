@@ -0,0 +1,190 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "format/Asciidoc.hpp"
+#include "format/CharScanner.hpp"
+#include "format/XMLTags.hpp"
+#include <mrdox/Reporter.hpp>
+#include <llvm/Support/raw_ostream.h>
+#include <random>
+#include <string>
+
+namespace clang {
+namespace mrdox {
+
+namespace {
+
+// The sets used by the XML and Asciidoc generators
+constexpr llvm::StringRef escapeSets[] = {
+    xml::escape::chars,
+    asciidoc::escape::chars
+};
+
+/** Return a random string which often contains characters of a set.
+
+    Bytes with the high bit set are included, so
+    sign extension in the vector comparisons would
+    show up as a mismatch.
+*/
+std::string
+randomString(
+    std::mt19937& gen,
+    llvm::StringRef set)
+{
+    std::uniform_int_distribution<int> size(0, 200);
+    std::uniform_int_distribution<int> pick(0, 7);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<std::size_t> member(0, set.size() - 1);
+    std::string s(size(gen), '\0');
+    for(char& c : s)
+    {
+        if(pick(gen) == 0)
+            c = set[member(gen)];
+        else if(pick(gen) == 0)
+            c = static_cast<char>(set[member(gen)] | 0x80);
+        else
+            c = static_cast<char>(byte(gen));
+    }
+    return s;
+}
+
+std::string
+escapeXMLScalar(
+    llvm::StringRef s)
+{
+    std::string result;
+    for(char c : s)
+    {
+        switch(c)
+        {
+        case '<':  result += "&lt;"; break;
+        case '>':  result += "&gt;"; break;
+        case '&':  result += "&amp;"; break;
+        case '\'': result += "&apos;"; break;
+        case '\"': result += "&quot;"; break;
+        default:   result += c; break;
+        }
+    }
+    return result;
+}
+
+std::string
+escapeAsciidocScalar(
+    llvm::StringRef s)
+{
+    std::string result;
+    for(char c : s)
+    {
+        if(asciidoc::escape::chars.contains(c))
+            result += "&#" + std::to_string(
+                static_cast<unsigned char>(c)) + ";";
+        else
+            result += c;
+    }
+    return result;
+}
+
+/** Return the output of an escaping manipulator.
+*/
+template<class Escape>
+std::string
+escaped(
+    llvm::StringRef s)
+{
+    std::string result;
+    llvm::raw_string_ostream os(result);
+    os << Escape(s);
+    os.flush();
+    return result;
+}
+
+} // (anon)
+
+/** Compare the vector character scanners against the scalar one,
+    and the escaping of each generator against a plain loop.
+*/
+void
+testEscape(
+    Reporter& R)
+{
+    using Kind = CharScanner::Kind;
+
+    std::mt19937 gen(20230401);
+    for(llvm::StringRef set : escapeSets)
+    {
+        CharScanner const scalar(set, Kind::scalar);
+        for(Kind kind : { Kind::sse2, Kind::avx2 })
+        {
+            if(! CharScanner::isSupported(kind))
+                continue;
+            CharScanner const scanner(set, kind);
+            for(int i = 0; i < 2000; ++i)
+            {
+                auto const s = randomString(gen, set);
+                for(std::size_t pos = 0; pos <= s.size(); ++pos)
+                {
+                    auto const expected = scalar.find(s, pos);
+                    auto const got = scanner.find(s, pos);
+                    if(got == expected)
+                        continue;
+                    R.print(
+                        "CharScanner ", CharScanner::name(kind),
+                        " failed for the set \"", set,
+                        "\" at position ", pos, ".\n",
+                        "Expected: ", expected, "\n",
+                        "Got: ", got, "\n");
+                    R.reportTestFailure();
+                    return;
+                }
+            }
+        }
+    }
+
+    for(int i = 0; i < 2000; ++i)
+    {
+        auto const s = randomString(gen, escapeSets[0]);
+        if(escaped<xml::escape>(s) != escapeXMLScalar(s))
+        {
+            R.print("xml::escape failed.\n");
+            R.reportTestFailure();
+            return;
+        }
+    }
+
+    // Markup in a comment must come out as text
+    {
+        auto const got = escaped<asciidoc::escape>("a*b_c`{x}[y]");
+        llvm::StringRef const expected =
+            "a&#42;b&#95;c&#96;&#123;x}&#91;y]";
+        if(got != expected)
+        {
+            R.print(
+                "asciidoc::escape failed.\n",
+                "Expected: ", expected, "\n",
+                "Got: ", got, "\n");
+            R.reportTestFailure();
+            return;
+        }
+    }
+
+    for(int i = 0; i < 2000; ++i)
+    {
+        auto const s = randomString(gen, escapeSets[1]);
+        if(escaped<asciidoc::escape>(s) != escapeAsciidocScalar(s))
+        {
+            R.print("asciidoc::escape failed.\n");
+            R.reportTestFailure();
+            return;
+        }
+    }
+}
+
+} // mrdox
+} // clang
@@ -0,0 +1,115 @@
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Copyright (c) 2023 Vinnie Falco (vinnie.falco@gmail.com)
+//
+// Official repository: https://github.com/cppalliance/mrdox
+//
+
+#include "ast/ProcessPool.hpp"
+#include <mrdox/Reporter.hpp>
+#include <llvm/Config/llvm-config.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#ifdef LLVM_ON_UNIX
+#include <signal.h>
+#endif
+
+namespace clang {
+namespace mrdox {
+
+/** Check that a crash in a worker process does not duplicate symbols.
+
+    Each translation unit adds one symbol, and sends
+    back a memory measurement of its own. The one
+    which crashes is retried in a new child, which
+    is forked after the parent collected the others,
+    and must not send them back a second time.
+*/
+void
+testProcessPool(
+    Reporter& R)
+{
+#ifdef LLVM_ON_UNIX
+    if(! ProcessPool::isSupported())
+        return;
+
+    constexpr std::size_t count = 8;
+    constexpr std::size_t crashing = 3;
+
+    // The child which maps the crashing translation
+    // unit is killed, and the one forked to retry it
+    // sees that it was already crashed once.
+    bool crashed = false;
+    TUResults results;
+    ProcessPool pool(1, results,
+        [&](std::size_t i)
+        {
+            if(i == crashing && ! crashed)
+                ::raise(SIGKILL);
+            TUData tu;
+            tu.data.assign(4, static_cast<char>(i));
+            TUData::Slice slice{};
+            slice.id[0] = static_cast<std::uint8_t>(i + 1);
+            slice.size = 4;
+            tu.index.push_back(slice);
+            results.add(std::move(tu));
+            ProcessPool::Outcome outcome;
+            outcome.ok = true;
+            outcome.fileSize = 4;
+            outcome.memory = 1000 + i;
+            return outcome;
+        },
+        {},
+        std::chrono::seconds(0));
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        for(;;)
+        {
+            auto ok = pool.run(0, i);
+            if(ok)
+            {
+                if(ok->memory != 1000 + i)
+                {
+                    R.print("ProcessPool: translation unit ", i,
+                        " sent the wrong measurement.\n");
+                    R.reportTestFailure();
+                    return;
+                }
+                break;
+            }
+            llvm::consumeError(ok.takeError());
+            if(crashed || i != crashing)
+            {
+                R.print("ProcessPool: translation unit ", i, " failed.\n");
+                R.reportTestFailure();
+                return;
+            }
+            crashed = true;
+        }
+    }
+
+    std::vector<SymbolID> ids;
+    for(auto const& tu : results.results())
+        for(auto const& slice : tu.index)
+            ids.push_back(slice.id);
+    std::sort(ids.begin(), ids.end());
+    bool const unique =
+        std::adjacent_find(ids.begin(), ids.end()) == ids.end();
+    if(ids.size() != count || ! unique)
+    {
+        R.print(
+            "ProcessPool: expected ", count, " symbols.\n",
+            "Got: ", ids.size(), unique ? "\n" : ", with duplicates\n");
+        R.reportTestFailure();
+    }
+#endif
+}
+
+} // mrdox
+} // clang
@@ -27,6 +27,8 @@ namespace mrdox {
 
 extern void dumpCommentTypes();
 extern void dumpCommentCommands();
+extern void testEscape(Reporter& R);
+extern void testProcessPool(Reporter& R);
 
 void
 testMain(
@@ -35,24 +37,66 @@ testMain(
 {
     namespace path = llvm::sys::path;
 
-    // Each command line argument is processed
-    // as a directory which will be iterated
-    // recursively for tests.
-    for(int i = 1; i < argc; ++i)
+    // Optional leading arguments select the
+    // intermediate format used to build each
+    // corpus, and whether the multi-page output
+    // is checked for independence of the number
+    // of threads, which builds each test again.
+    llvm::StringRef format = "bitcode";
+    bool checkPages = false;
+    int first = 1;
+    for(; first < argc; ++first)
     {
-        auto config = Config::createAtDirectory(argv[i]);
-        if(! config)
-            return (void)R.error(config, "create config at directory '", argv[i], "'");
+        llvm::StringRef arg(argv[first]);
+        if(arg.consume_front("--intermediate-format="))
+            format = arg;
+        else if(arg == "--check-pages")
+            checkPages = true;
+        else
+            break;
+    }
+
+    testEscape(R);
+    testProcessPool(R);
+
+    // Each remaining command line argument is
+    // processed as a directory which will be
+    // iterated recursively for tests.
+    for(int i = first; i < argc; ++i)
+    {
+        // The first config is used for the tests. If
+        // the pages are checked, they are rendered with
+        // several threads using the second, and with
+        // one using the third.
+        std::unique_ptr<Config> configs[3];
+        for(auto& config : configs)
+        {
+            auto result = Config::createAtDirectory(argv[i]);
+            if(! result)
+                return (void)R.error(result, "create config at directory '", argv[i], "'");
+            config = std::move(*result);
 
-        // Set source root to config dir
-        (*config)->setSourceRoot((*config)->configDir());
+            // Set source root to config dir
+            config->setSourceRoot(config->configDir());
 
-        (*config)->setVerbose(false);
+            config->setVerbose(false);
+            config->setIntermediateFormat(format);
+            if(! checkPages)
+                break;
+        }
 
         // We need a different config for each directory
         // passed on the command line, and thus each must
         // also have a separate Tester.
-        Tester tester(**config, R);
+        Tester tester(*configs[0], R);
+        if(checkPages)
+        {
+            configs[1]->setMultiPage(true);
+            configs[1]->setJobs(0, 0, 4);
+            configs[2]->setMultiPage(true);
+            configs[2]->setJobs(0, 0, 1);
+            tester.checkPagesWith(*configs[1], *configs[2]);
+        }
         llvm::StringRef s(argv[i]);
         llvm::SmallString<340> dirPath(s);
         path::remove_dots(dirPath, true);
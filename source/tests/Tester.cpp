@@ -10,13 +10,65 @@
 
 #include "Tester.hpp"
 #include "SingleFile.hpp"
-#include <clang/Tooling/StandaloneExecution.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #define NO_ASYNC
 
 namespace clang {
 namespace mrdox {
 
+namespace {
+
+/*  Return the paths of the files in a directory
+    tree, relative to the directory and sorted.
+*/
+std::vector<std::string>
+listFiles(
+    llvm::StringRef dirPath,
+    std::error_code& ec)
+{
+    namespace fs = llvm::sys::fs;
+
+    std::vector<std::string> files;
+    fs::recursive_directory_iterator const end{};
+    fs::recursive_directory_iterator iter(dirPath, ec, false);
+    for(; ! ec && iter != end; iter.increment(ec))
+    {
+        if(iter->type() != fs::file_type::regular_file)
+            continue;
+        llvm::StringRef relPath(iter->path());
+        relPath.consume_front(dirPath);
+        files.push_back(relPath.str());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/*  Create a new directory in the system's
+    temporary directory, for output which
+    is removed after it was checked.
+*/
+std::error_code
+createTempDirectory(
+    llvm::StringRef prefix,
+    llvm::SmallVectorImpl<char>& dir)
+{
+    namespace fs = llvm::sys::fs;
+    namespace path = llvm::sys::path;
+
+    llvm::SmallString<128> model;
+    path::system_temp_directory(true, model);
+    path::append(model, prefix + "-%%%%%%");
+    return fs::createUniqueDirectory(model, dir);
+}
+
+} // (anon)
+
 Tester::
 Tester(
     Config const& config,
@@ -28,6 +80,16 @@ Tester(
 {
 }
 
+void
+Tester::
+checkPagesWith(
+    Config const& config,
+    Config const& serialConfig)
+{
+    pagesConfig_ = &config;
+    serialPagesConfig_ = &serialConfig;
+}
+
 bool
 Tester::
 checkDirRecursively(
@@ -68,10 +130,23 @@ checkDirRecursively(
                     ]() mutable
                 {
                     SingleFile db(dirPath, inputPath, outputPath);
-                    tooling::StandaloneToolExecutor ex(db, { std::string(inputPath) });
-                    auto corpus = Corpus::build(ex, config_, R_);
-                    if(! R_.error(corpus, "build corpus for '", inputPath, "'"))
-                        checkOneFile(**corpus, inputPath, outputPath);
+                    auto corpus = Corpus::build(db, config_, R_);
+                    if(R_.error(corpus, "build corpus for '", inputPath, "'"))
+                        return;
+                    checkOneFile(**corpus, inputPath, outputPath);
+                    std::call_once(outputDirChecked_, [&]
+                    {
+                        checkOutputDirectory(**corpus, inputPath);
+                    });
+                    if(! pagesConfig_)
+                        return;
+                    auto pagesCorpus = Corpus::build(db, *pagesConfig_, R_);
+                    if(R_.error(pagesCorpus, "build corpus for '", inputPath, "'"))
+                        return;
+                    auto serialCorpus = Corpus::build(db, *serialPagesConfig_, R_);
+                    if(R_.error(serialCorpus, "build corpus for '", inputPath, "'"))
+                        return;
+                    checkPages(**pagesCorpus, **serialCorpus, inputPath);
                 }
 #ifndef NO_ASYNC
             );
@@ -93,7 +168,7 @@ checkDirRecursively(
 void
 Tester::
 checkOneFile(
-    Corpus& corpus,
+    Corpus const& corpus,
     llvm::StringRef inputPath,
     llvm::SmallVectorImpl<char>& outputPathStr)
 {
@@ -156,5 +231,118 @@ checkOneFile(
     }
 }
 
+void
+Tester::
+checkOutputDirectory(
+    Corpus const& corpus,
+    llvm::StringRef inputPath)
+{
+    namespace fs = llvm::sys::fs;
+    namespace path = llvm::sys::path;
+
+    if(! adocGen)
+        return;
+
+    // Every format is built into a directory
+    // which does not exist yet, so that the
+    // generators must create it.
+    llvm::SmallString<128> dir;
+    if(R_.error(createTempDirectory("mrdox-output", dir),
+            "create a temporary directory"))
+        return;
+    llvm::SmallString<128> outputPath(dir);
+    path::append(outputPath, "docs");
+    Generator const* gens[] = { adocGen.get(), xmlGen.get() };
+    if(buildAll(gens, outputPath, corpus, config_, R_))
+    {
+        for(auto const* gen : gens)
+        {
+            llvm::SmallString<128> fileName(outputPath);
+            path::append(fileName, "reference");
+            path::replace_extension(fileName, gen->extension());
+            if(! fs::is_regular_file(fileName))
+            {
+                R_.print("File: \"", inputPath, "\" failed.\n",
+                    "No '", fileName, "' was built in a new directory.\n");
+                R_.reportTestFailure();
+            }
+        }
+    }
+    else
+    {
+        R_.print("File: \"", inputPath, "\" failed.\n",
+            "The formats could not be built into a new directory.\n");
+        R_.reportTestFailure();
+    }
+    fs::remove_directories(dir);
+}
+
+void
+Tester::
+checkPages(
+    Corpus const& corpus,
+    Corpus const& serialCorpus,
+    llvm::StringRef inputPath)
+{
+    namespace fs = llvm::sys::fs;
+
+    if(! adocGen)
+        return;
+
+    // The pages are rendered with several
+    // threads and with one, into two new
+    // directories which are removed after.
+    llvm::SmallString<128> dirs[2];
+    for(auto& dir : dirs)
+    {
+        if(R_.error(createTempDirectory("mrdox-pages", dir),
+                "create a temporary directory"))
+        {
+            for(auto& created : dirs)
+                if(! created.empty())
+                    fs::remove_directories(created);
+            return;
+        }
+    }
+    auto check = [&]
+    {
+        if(! adocGen->build(dirs[0], corpus, *pagesConfig_, R_) ||
+            ! adocGen->build(dirs[1], serialCorpus, *serialPagesConfig_, R_))
+            return;
+        std::error_code ec;
+        auto const files = listFiles(dirs[0], ec);
+        if(R_.error(ec, "iterate the directory '", dirs[0], "'"))
+            return;
+        if(listFiles(dirs[1], ec) != files)
+        {
+            if(! R_.error(ec, "iterate the directory '", dirs[1], "'"))
+            {
+                R_.print("File: \"", inputPath, "\" failed.\n",
+                    "The pages depend on the number of threads.\n");
+                R_.reportTestFailure();
+            }
+            return;
+        }
+        for(auto const& file : files)
+        {
+            auto b0 = llvm::MemoryBuffer::getFile(dirs[0] + file);
+            auto b1 = llvm::MemoryBuffer::getFile(dirs[1] + file);
+            if( R_.error(b0, "read the page '", file, "'") ||
+                R_.error(b1, "read the page '", file, "'"))
+                return;
+            if((*b0)->getBuffer() != (*b1)->getBuffer())
+            {
+                R_.print("File: \"", inputPath, "\" failed.\n",
+                    "The page '", file, "' depends on the number of threads.\n");
+                R_.reportTestFailure();
+                return;
+            }
+        }
+    };
+    check();
+    for(auto const& dir : dirs)
+        fs::remove_directories(dir);
+}
+
 } // mrdox
 } // clang
@@ -15,12 +15,18 @@
 // A .cpp file containing valid declarations,
 // and a .xml file containing the expected output
 // of the XML generator, which must match exactly.
+//
+// Optionally, the multi-page Asciidoc output of
+// each test is also rendered with several threads
+// and with one, and the two trees of files must
+// be the same.
 
 #include <mrdox/Config.hpp>
 #include <mrdox/format/Generator.hpp>
 #include <mrdox/Reporter.hpp>
 #include <llvm/Support/ThreadPool.h>
 #include <memory>
+#include <mutex>
 
 namespace clang {
 namespace mrdox {
@@ -28,16 +34,35 @@ namespace mrdox {
 class Tester
 {
     Config const& config_;
+    Config const* pagesConfig_ = nullptr;
+    Config const* serialPagesConfig_ = nullptr;
     std::unique_ptr<Generator> xmlGen;
     std::unique_ptr<Generator> adocGen;
     Reporter& R_;
+    std::once_flag outputDirChecked_;
 
 public:
-    explicit
     Tester(
         Config const& config,
         Reporter &R);
 
+    /** Also check that the pages do not depend on the number of threads.
+
+        Each test is built twice more, once with
+        each configuration, and the multi-page
+        output of the two must be the same.
+
+        @param config A multi-page configuration,
+        with several threads for the generate phase.
+
+        @param serialConfig The same configuration,
+        with one thread for the generate phase.
+    */
+    void
+    checkPagesWith(
+        Config const& config,
+        Config const& serialConfig);
+
     bool
     checkDirRecursively(
         llvm::SmallString<340> dirPath,
@@ -45,9 +70,22 @@ public:
 
     void
     checkOneFile(
-        Corpus& corpus,
+        Corpus const& corpus,
         llvm::StringRef inputPath,
         llvm::SmallVectorImpl<char>& outputPathStr);
+
+    /** Check that every format builds into a missing directory.
+    */
+    void
+    checkOutputDirectory(
+        Corpus const& corpus,
+        llvm::StringRef inputPath);
+
+    void
+    checkPages(
+        Corpus const& corpus,
+        Corpus const& serialCorpus,
+        llvm::StringRef inputPath);
 };
 
 } // mrdox
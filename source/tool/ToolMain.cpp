@@ -23,10 +23,12 @@
 #include <mrdox/Corpus.hpp>
 #include <mrdox/Reporter.hpp>
 #include <mrdox/format/Generator.hpp>
-#include <clang/Tooling/AllTUsExecution.h>
 #include <clang/Tooling/CommonOptionsParser.h>
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/Support/CommandLine.h>
 #include <llvm/Support/Signals.h>
+#include <algorithm>
+#include <vector>
 
 #if 0
 #if defined(_MSC_VER) && ! defined(NDEBUG)
@@ -50,6 +52,7 @@ Examples
 
   $ mrdox mrdox.yml
   $ mrdox --config=mrdox.yml --output ./docs
+  $ mrdox --config=mrdox.yml --format=xml,adoc --output ./docs
 )";
 
 static
@@ -73,7 +76,7 @@ static
 llvm::cl::opt<std::string>
 FormatType(
     "format",
-    llvm::cl::desc("Format for outputted docs (\"adoc\" or \"xml\")."),
+    llvm::cl::desc("Formats for outputted docs, separated by commas (\"adoc\", \"xml\")."),
     llvm::cl::init("adoc"),
     llvm::cl::cat(ToolCategory));
 
@@ -93,6 +96,54 @@ OutDirectory(
     llvm::cl::init("."),
     llvm::cl::cat(ToolCategory));
 
+static
+llvm::cl::opt<unsigned>
+MapJobs(
+    "map-jobs",
+    llvm::cl::desc("Number of translation units to visit at once (0 for all threads)."),
+    llvm::cl::init(0),
+    llvm::cl::cat(ToolCategory));
+
+static
+llvm::cl::opt<unsigned>
+ReduceJobs(
+    "reduce-jobs",
+    llvm::cl::desc("Number of threads merging symbols at once (0 for all threads)."),
+    llvm::cl::init(0),
+    llvm::cl::cat(ToolCategory));
+
+static
+llvm::cl::opt<unsigned>
+GenJobs(
+    "gen-jobs",
+    llvm::cl::desc("Number of threads generating output at once (0 for all threads)."),
+    llvm::cl::init(0),
+    llvm::cl::cat(ToolCategory));
+
+static
+llvm::cl::opt<unsigned>
+MemoryBudget(
+    "memory-budget",
+    llvm::cl::desc("Megabytes of memory for the translation units parsed at once (0 for no limit)."),
+    llvm::cl::init(0),
+    llvm::cl::cat(ToolCategory));
+
+static
+llvm::cl::opt<bool>
+IsolateMap(
+    "isolate-map",
+    llvm::cl::desc("Map translation units in worker processes, so a crash skips only one."),
+    llvm::cl::init(false),
+    llvm::cl::cat(ToolCategory));
+
+static
+llvm::cl::opt<bool>
+MultiPage(
+    "multi-page",
+    llvm::cl::desc("Write one page per namespace, record and overload set."),
+    llvm::cl::init(false),
+    llvm::cl::cat(ToolCategory));
+
 } // (anon)
 
 //------------------------------------------------
@@ -119,35 +170,57 @@ toolMain(
     (*config)->OutDirectory = OutDirectory;
     (*config)->IgnoreMappingFailures = IgnoreMappingFailures;
 
-    // create the executor
-    auto ex = std::make_unique<tooling::AllTUsToolExecutor>(
-        optionsResult->getCompilations(), 0);
-
-    // create the generator
-    Generator const* gen;
+    // Limits on the command line override the config file
+    (*config)->setJobs(
+        MapJobs.getNumOccurrences() ? MapJobs.getValue() : (*config)->mapJobs(),
+        ReduceJobs.getNumOccurrences() ? ReduceJobs.getValue() : (*config)->reduceJobs(),
+        GenJobs.getNumOccurrences() ? GenJobs.getValue() : (*config)->genJobs());
+    if(MemoryBudget.getNumOccurrences())
+        (*config)->setMemoryBudget(MemoryBudget);
+    if(IsolateMap.getNumOccurrences())
+        (*config)->setMapIsolation(IsolateMap,
+            (*config)->mapRetries(), (*config)->mapTimeout());
+    if(MultiPage.getNumOccurrences())
+        (*config)->setMultiPage(MultiPage);
+
+    // find the generators
+    std::vector<Generator const*> gens;
     {
-        auto it = std::find_if(
-            formats.begin(), formats.end(),
-            [](std::unique_ptr<Generator> const& up)
+        llvm::SmallVector<llvm::StringRef, 4> names;
+        llvm::StringRef(FormatType).split(names, ',', -1, false);
+        for(auto name : names)
+        {
+            name = name.trim();
+            auto it = std::find_if(
+                formats.begin(), formats.end(),
+                [name](std::unique_ptr<Generator> const& up)
+                {
+                    return up->extension().equals_insensitive(name);
+                });
+            if(it == formats.end())
             {
-                return up->extension().equals_insensitive(FormatType.getValue());
-            });
-        if(it == formats.end())
+                R.print("find the generator for '", name, "'");
+                return;
+            }
+            if(std::find(gens.begin(), gens.end(), it->get()) == gens.end())
+                gens.push_back(it->get());
+        }
+        if(gens.empty())
         {
-            R.print("find the generator for '", FormatType.getValue(), "'");
+            R.print("find a generator in '", FormatType.getValue(), "'");
             return;
         }
-        gen = it->get();
     }
 
     // Run the tool, this can take a while
-    auto corpus = Corpus::build(*ex, **config, R);
+    auto corpus = Corpus::build(
+        optionsResult->getCompilations(), **config, R);
     if(R.error(corpus, "build the documentation corpus"))
         return;
 
-    // Run the generator.
+    // Run the generators on the same corpus
     llvm::outs() << "Generating docs...\n";
-    if(! gen->build((*config)->OutDirectory, **corpus, **config, R))
+    if(! buildAll(gens, (*config)->OutDirectory, **corpus, **config, R))
         return;
 }
 